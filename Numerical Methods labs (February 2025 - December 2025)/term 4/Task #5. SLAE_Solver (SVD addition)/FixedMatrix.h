@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+// Fixed-size kernels for small systems. Sizes are template parameters, every loop
+// is unrolled at compile time through unroll<>, the data lives on the stack.
+// LU and the solves are constexpr; QR is not, std::sqrt is not constexpr in C++17.
+
+template <int N>
+using FixedVector = std::array<double, N>;
+
+template <int N>
+using FixedMatrix = std::array<std::array<double, N>, N>;
+
+// Calls f(std::integral_constant<int, I>) for I = Begin..End-1
+template <int Begin, int End, typename F>
+constexpr void unroll(F&& f) {
+    if constexpr (Begin < End) {
+        f(std::integral_constant<int, Begin>{});
+        unroll<Begin + 1, End>(f);
+    }
+}
+
+constexpr double fixedAbs(double x) {
+    return x < 0.0 ? -x : x;
+}
+
+// PA = LU with partial pivoting, same layout as luDecomposition
+template <int N>
+constexpr void lu(FixedMatrix<N>& A, std::array<int, N>& pivot) {
+    unroll<0, N>([&](auto i) { pivot[i] = i; });
+
+    unroll<0, N>([&](auto kc) {
+        constexpr int k = decltype(kc)::value;
+
+        // Partial pivoting
+        int max_row = k;
+        unroll<k + 1, N>([&](auto i) {
+            if (fixedAbs(A[i][k]) > fixedAbs(A[max_row][k])) max_row = i;
+        });
+        if (max_row != k) {
+            unroll<0, N>([&](auto j) {
+                double t = A[k][j];
+                A[k][j] = A[max_row][j];
+                A[max_row][j] = t;
+            });
+            int t = pivot[k];
+            pivot[k] = pivot[max_row];
+            pivot[max_row] = t;
+        }
+
+        unroll<k + 1, N>([&](auto i) {
+            A[i][k] /= A[k][k];
+            unroll<k + 1, N>([&](auto j) {
+                A[i][j] -= A[i][k] * A[k][j];
+            });
+        });
+    });
+}
+
+template <int N>
+constexpr FixedVector<N> solveLU(const FixedMatrix<N>& LU, const std::array<int, N>& pivot,
+    const FixedVector<N>& f) {
+    FixedVector<N> y{};
+    unroll<0, N>([&](auto i) {
+        y[i] = f[pivot[i]];
+        unroll<0, decltype(i)::value>([&](auto j) { y[i] -= LU[i][j] * y[j]; });
+    });
+
+    FixedVector<N> x{};
+    unroll<0, N>([&](auto r) {
+        constexpr int i = N - 1 - decltype(r)::value;
+        x[i] = y[i];
+        unroll<i + 1, N>([&](auto j) { x[i] -= LU[i][j] * x[j]; });
+        x[i] /= LU[i][i];
+    });
+    return x;
+}
+
+template <int N>
+constexpr FixedVector<N> solve(FixedMatrix<N> A, const FixedVector<N>& f) {
+    std::array<int, N> pivot{};
+    lu<N>(A, pivot);
+    return solveLU<N>(A, pivot, f);
+}
+
+// Householder QR, reflectors below the diagonal (v[k] = 1 implicit), R on and above it
+template <int N>
+void qr(FixedMatrix<N>& A, FixedVector<N>& tau) {
+    unroll<0, N>([&](auto kc) {
+        constexpr int k = decltype(kc)::value;
+        tau[k] = 0.0;
+
+        double alpha = A[k][k];
+        double sigma = 0.0;
+        unroll<k + 1, N>([&](auto i) { sigma += A[i][k] * A[i][k]; });
+        if (sigma == 0.0) return;
+
+        double beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        double scale = 1.0 / (alpha - beta);
+        unroll<k + 1, N>([&](auto i) { A[i][k] *= scale; });
+        A[k][k] = beta;
+        tau[k] = (beta - alpha) / beta;
+
+        unroll<k + 1, N>([&](auto j) {
+            double dot = A[k][j];
+            unroll<k + 1, N>([&](auto i) { dot += A[i][k] * A[i][j]; });
+            dot *= tau[k];
+            A[k][j] -= dot;
+            unroll<k + 1, N>([&](auto i) { A[i][j] -= dot * A[i][k]; });
+        });
+    });
+}
+
+template <int N>
+constexpr FixedVector<N> solveQR(const FixedMatrix<N>& QR, const FixedVector<N>& tau,
+    FixedVector<N> y) {
+    // y = Q^T * f
+    unroll<0, N>([&](auto kc) {
+        constexpr int k = decltype(kc)::value;
+        double dot = y[k];
+        unroll<k + 1, N>([&](auto i) { dot += QR[i][k] * y[i]; });
+        dot *= tau[k];
+        y[k] -= dot;
+        unroll<k + 1, N>([&](auto i) { y[i] -= dot * QR[i][k]; });
+    });
+
+    // R * x = y
+    unroll<0, N>([&](auto r) {
+        constexpr int i = N - 1 - decltype(r)::value;
+        unroll<i + 1, N>([&](auto j) { y[i] -= QR[i][j] * y[j]; });
+        y[i] /= QR[i][i];
+    });
+    return y;
+}
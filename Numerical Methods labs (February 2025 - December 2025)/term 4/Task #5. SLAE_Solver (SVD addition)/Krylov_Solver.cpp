@@ -0,0 +1,99 @@
+#include "LinearOperator.h"
+#include <cmath>
+
+static double dot(const Vector& a, const Vector& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// Only the operator is touched, so it works the same for dense and matrix-free A.
+// Memory is (restart + 3) vectors of length N.
+Vector solveGMRES(const LinearOperator& A, const Vector& f, double tol,
+    int restart, int maxIter, int* iterations) {
+    int n = A.rows();
+    Vector x(n, 0.0);
+    int total = 0;
+
+    // Jacobi right preconditioner: A * D^{-1} * u = f, x = D^{-1} * u
+    Vector d;
+    A.diagonal(d);
+    Vector invDiag(n, 1.0);
+    for (int i = 0; i < n; ++i)
+        if (d[i] != 0.0) invDiag[i] = 1.0 / d[i];
+
+    double target = tol * sqrt(dot(f, f));
+    Matrix V(restart + 1, Vector(n));
+    Matrix H(restart + 1, Vector(restart, 0.0));
+    Vector cs(restart), sn(restart), g(restart + 1), z(n), w(n);
+
+    while (total < maxIter) {
+        // r = f - A * x
+        A.apply(x, w);
+        for (int i = 0; i < n; ++i)
+            V[0][i] = f[i] - w[i];
+        double beta = sqrt(dot(V[0], V[0]));
+        if (beta <= target) break;
+        for (int i = 0; i < n; ++i)
+            V[0][i] /= beta;
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        int k = 0;
+        bool converged = false;
+        while (k < restart && total < maxIter && !converged) {
+            // Arnoldi step with modified Gram-Schmidt
+            for (int i = 0; i < n; ++i)
+                z[i] = invDiag[i] * V[k][i];
+            A.apply(z, w);
+            for (int p = 0; p <= k; ++p) {
+                H[p][k] = dot(w, V[p]);
+                for (int i = 0; i < n; ++i)
+                    w[i] -= H[p][k] * V[p][i];
+            }
+            H[k + 1][k] = sqrt(dot(w, w));
+            if (H[k + 1][k] > 0.0)
+                for (int i = 0; i < n; ++i)
+                    V[k + 1][i] = w[i] / H[k + 1][k];
+
+            // Previous rotations, then a new one that zeros H[k + 1][k]
+            for (int p = 0; p < k; ++p) {
+                double a = H[p][k], b = H[p + 1][k];
+                H[p][k] = cs[p] * a + sn[p] * b;
+                H[p + 1][k] = -sn[p] * a + cs[p] * b;
+            }
+            double r = std::hypot(H[k][k], H[k + 1][k]);
+            cs[k] = r > 0.0 ? H[k][k] / r : 1.0;
+            sn[k] = r > 0.0 ? H[k + 1][k] / r : 0.0;
+            H[k][k] = r;
+            H[k + 1][k] = 0.0;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+
+            ++k;
+            ++total;
+            converged = std::abs(g[k]) <= target || H[k - 1][k - 1] == 0.0;
+        }
+
+        // H * y = g, then x += D^{-1} * V * y
+        Vector y(k, 0.0);
+        for (int i = k - 1; i >= 0; --i) {
+            y[i] = g[i];
+            for (int j = i + 1; j < k; ++j)
+                y[i] -= H[i][j] * y[j];
+            y[i] = H[i][i] != 0.0 ? y[i] / H[i][i] : 0.0;
+        }
+        std::fill(z.begin(), z.end(), 0.0);
+        for (int p = 0; p < k; ++p)
+            for (int i = 0; i < n; ++i)
+                z[i] += y[p] * V[p][i];
+        for (int i = 0; i < n; ++i)
+            x[i] += invDiag[i] * z[i];
+
+        if (converged) break;
+    }
+
+    if (iterations) *iterations = total;
+    return x;
+}
@@ -1,7 +1,10 @@
 #include "LinearAlgebra.h"
+#include "FixedMatrix.h"
+#include "Profiler.h"
 #include <algorithm>
 
 void luDecomposition(Matrix& A, std::vector<int>& pivot) {
+    PROFILE_SCOPE("lu.factor");
     int N = A.size();
     pivot.resize(N);
     for (int i = 0; i < N; ++i) pivot[i] = i;
@@ -9,18 +12,23 @@ void luDecomposition(Matrix& A, std::vector<int>& pivot) {
     for (int k = 0; k < N; ++k) {
         // Partial pivoting
         int max_row = k;
-        for (int i = k + 1; i < N; ++i) {
-            if (std::abs(A[i][k]) > std::abs(A[max_row][k])) {
-                max_row = i;
+        {
+            PROFILE_SCOPE("lu.pivot_search");
+            for (int i = k + 1; i < N; ++i) {
+                if (std::abs(A[i][k]) > std::abs(A[max_row][k])) {
+                    max_row = i;
+                }
             }
         }
 
         if (max_row != k) {
             std::swap(A[k], A[max_row]);
             std::swap(pivot[k], pivot[max_row]);
+            PROFILE_COUNT("lu.row_swaps", 1);
         }
 
         // LU decomposition
+        PROFILE_SCOPE("lu.trailing_update");
         for (int i = k + 1; i < N; ++i) {
             A[i][k] /= A[k][k];
             for (int j = k + 1; j < N; ++j) {
@@ -31,6 +39,7 @@ void luDecomposition(Matrix& A, std::vector<int>& pivot) {
 }
 
 Vector solveLU(const Matrix& LU, const std::vector<int>& pivot, const Vector& f) {
+    PROFILE_SCOPE("lu.solve");
     int N = LU.size();
     Vector x(N), b(N), y(N);
 
@@ -57,4 +66,36 @@ Vector solveLU(const Matrix& LU, const std::vector<int>& pivot, const Vector& f)
     }
 
     return x;
+}
+
+template <int N>
+static Vector solveFixed(const Matrix& A, const Vector& f) {
+    FixedMatrix<N> a;
+    FixedVector<N> b;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j)
+            a[i][j] = A[i][j];
+        b[i] = f[i];
+    }
+    FixedVector<N> x = solve<N>(a, b);
+    return Vector(x.begin(), x.end());
+}
+
+// LU solve of a copy of A; the common small sizes go to the unrolled fixed-size kernels
+Vector solveDirect(const Matrix& A, const Vector& f) {
+    switch (A.size()) {
+    case 3: return solveFixed<3>(A, f);
+    case 4: return solveFixed<4>(A, f);
+    case 5: return solveFixed<5>(A, f);
+    case 6: return solveFixed<6>(A, f);
+    case 8: return solveFixed<8>(A, f);
+    case 10: return solveFixed<10>(A, f);
+    case 20: return solveFixed<20>(A, f);
+    default: {
+        Matrix LU = A;
+        std::vector<int> pivot;
+        luDecomposition(LU, pivot);
+        return solveLU(LU, pivot, f);
+    }
+    }
 }
\ No newline at end of file
@@ -10,20 +10,71 @@ using Vector = std::vector<double>;
 // Matrix operations
 Matrix createMatrix(int N);
 Matrix transpose(const Matrix& A);
-Matrix multiply(const Matrix& A, const Matrix& B);
+void transposeInPlace(Matrix& A);
+Matrix multiply(const Matrix& A, const Matrix& B, bool transA = false, bool transB = false);
+Matrix syrk(const Matrix& A, bool trans = true);
+Vector multiply(const Matrix& A, const Vector& x, bool transA = false);
 Vector createRightHandSide(const Matrix& A);
+Vector rowSums(const Matrix& A);
 double computeError(const Vector& x, const Vector& x_exact);
 double computeConditionNumber(const Matrix& A);
 
 // LU decomposition
 void luDecomposition(Matrix& A, std::vector<int>& pivot);
 Vector solveLU(const Matrix& LU, const std::vector<int>& pivot, const Vector& f);
+Vector solveDirect(const Matrix& A, const Vector& f);  // fixed-size kernels for N = 3..20 (FixedMatrix.h)
 
 // QR decomposition
 void householderQR(const Matrix& A, Matrix& Q, Matrix& R);
 Vector solveQR(const Matrix& Q, const Matrix& R, const Vector& f);
+Vector solveDirectQR(const Matrix& A, const Vector& f);  // fixed-size kernels for N = 3..20 (FixedMatrix.h)
+
+// QR decomposition with column pivoting (rank-revealing, blocked QP3)
+int pivotedQR(Matrix& A, Vector& tau, std::vector<int>& jpvt);
+void completeOrthogonal(Matrix& QR, int rank, Vector& tauZ);
+Vector solvePivotedQR(const Matrix& QR, const Vector& tau, const std::vector<int>& jpvt,
+    int rank, const Vector& f);
+Vector solveMinNormQR(const Matrix& QR, const Vector& tau, const std::vector<int>& jpvt,
+    int rank, const Vector& tauZ, const Vector& f);
+
+// Updates of existing factorizations, O(n^2) each
+void qrRank1Update(Matrix& Q, Matrix& R, const Vector& u, const Vector& v);
+void qrRankUpdate(Matrix& Q, Matrix& R, const Matrix& U, const Matrix& V);
+void qrInsertColumn(Matrix& Q, Matrix& R, int j, const Vector& a);
+void qrDeleteColumn(Matrix& Q, Matrix& R, int j);
+void qrInsertRow(Matrix& Q, Matrix& R, int i, const Vector& a);
+void qrDeleteRow(Matrix& Q, Matrix& R, int i);
+void woodburyPrepare(const Matrix& LU, const std::vector<int>& pivot,
+    const Matrix& U, const Matrix& V,
+    Matrix& Z, Matrix& capacitance, std::vector<int>& capPivot);
+Vector solveWoodbury(const Matrix& LU, const std::vector<int>& pivot, const Matrix& V,
+    const Matrix& Z, const Matrix& capacitance, const std::vector<int>& capPivot,
+    const Vector& f);
+Vector solveShermanMorrison(const Matrix& LU, const std::vector<int>& pivot,
+    const Vector& u, const Vector& v, const Vector& f);
 
 // SVD decomposition
 void computeEigenvalues(const Matrix& A, Vector& eigenvalues, Matrix& eigenvectors);
 void svdDecomposition(const Matrix& A, Matrix& U, Vector& S, Matrix& V);
 Vector solveSVD(const Matrix& U, const Vector& S, const Matrix& V, const Vector& f);
+
+// Tiled factorizations executed as task DAGs (TaskScheduler.h)
+struct TileMatrix {
+    int n = 0;   // size of the original matrix
+    int nb = 0;  // tile size
+    int nt = 0;  // tiles per side, the matrix is padded with identity up to nt * nb
+    std::vector<Vector> tiles;  // nt * nt row-major nb x nb tiles
+
+    double* tile(int i, int j) { return tiles[i * nt + j].data(); }
+    const double* tile(int i, int j) const { return tiles[i * nt + j].data(); }
+    double& at(int r, int c) { return tiles[(r / nb) * nt + c / nb][(r % nb) * nb + c % nb]; }
+    double at(int r, int c) const { return tiles[(r / nb) * nt + c / nb][(r % nb) * nb + c % nb]; }
+};
+
+TileMatrix toTiles(const Matrix& A, int nb);
+void tiledLU(TileMatrix& A, std::vector<int>& pivot, int numThreads);
+Vector solveTiledLU(const TileMatrix& LU, const std::vector<int>& pivot, const Vector& f);
+void tiledQR(TileMatrix& A, std::vector<Vector>& tau, int numThreads);
+Vector solveTiledQR(const TileMatrix& QR, const std::vector<Vector>& tau, const Vector& f);
+void tiledCholesky(TileMatrix& A, int numThreads);
+Vector solveTiledCholesky(const TileMatrix& L, const Vector& f);
@@ -0,0 +1,112 @@
+#include "LinearOperator.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// ==================== DenseOperator ====================
+
+void DenseOperator::apply(const Vector& x, Vector& y) const {
+    y = multiply(A, x);
+}
+
+void DenseOperator::applyTranspose(const Vector& x, Vector& y) const {
+    y = multiply(A, x, true);
+}
+
+void DenseOperator::diagonal(Vector& d) const {
+    int k = std::min(rows(), cols());
+    d.resize(k);
+    for (int i = 0; i < k; ++i)
+        d[i] = A[i][i];
+}
+
+bool DenseOperator::block(int i0, int j0, int m, int n, Matrix& out) const {
+    out.assign(m, Vector(n));
+    for (int i = 0; i < m; ++i)
+        std::copy(A[i0 + i].begin() + j0, A[i0 + i].begin() + j0 + n, out[i].begin());
+    return true;
+}
+
+// ==================== KernelOperator ====================
+
+const int KERNEL_TILE = 1024;          // columns per tile, the x and t slices stay in L1
+const int KERNEL_PARALLEL_MIN = 2048;  // smaller operators are applied on one thread
+
+// sum_j x[j] / (base + t[j]) over one column tile
+static double kernelRowDot(double base, const double* t, const double* x, int count) {
+    int j = 0;
+    double sum = 0.0;
+#if defined(__AVX__)
+    __m256d vbase = _mm256_set1_pd(base);
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    for (; j + 8 <= count; j += 8) {
+        __m256d d0 = _mm256_add_pd(vbase, _mm256_loadu_pd(t + j));
+        __m256d d1 = _mm256_add_pd(vbase, _mm256_loadu_pd(t + j + 4));
+        acc0 = _mm256_add_pd(acc0, _mm256_div_pd(_mm256_loadu_pd(x + j), d0));
+        acc1 = _mm256_add_pd(acc1, _mm256_div_pd(_mm256_loadu_pd(x + j + 4), d1));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    // Four independent partial sums, the compiler can keep them in one vector register
+    double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+    for (; j + 4 <= count; j += 4) {
+        s0 += x[j] / (base + t[j]);
+        s1 += x[j + 1] / (base + t[j + 1]);
+        s2 += x[j + 2] / (base + t[j + 2]);
+        s3 += x[j + 3] / (base + t[j + 3]);
+    }
+    sum = (s0 + s1) + (s2 + s3);
+#endif
+    for (; j < count; ++j)
+        sum += x[j] / (base + t[j]);
+    return sum;
+}
+
+// y_i = sum_j x_j / (c0 + rowCoef * (i + 1) + colCoef * (j + 1))
+static void kernelMatvec(int n, double c0, double rowCoef, double colCoef, int numThreads,
+    const Vector& x, Vector& y) {
+    Vector t(n);
+    for (int j = 0; j < n; ++j)
+        t[j] = colCoef * (j + 1);
+    y.assign(n, 0.0);
+
+    int threads = n < KERNEL_PARALLEL_MIN ? 1 : numThreads;
+    parallelFor(0, n, threads, [&](int lo, int hi) {
+        for (int j0 = 0; j0 < n; j0 += KERNEL_TILE) {
+            int count = std::min(KERNEL_TILE, n - j0);
+            for (int i = lo; i < hi; ++i)
+                y[i] += kernelRowDot(c0 + rowCoef * (i + 1), &t[j0], &x[j0], count);
+        }
+    });
+}
+
+KernelOperator::KernelOperator(int n, double c0, double c1, double c2, int numThreads)
+    : n(n), c0(c0), c1(c1), c2(c2),
+    numThreads(numThreads > 0 ? numThreads : defaultThreadCount()) {}
+
+void KernelOperator::apply(const Vector& x, Vector& y) const {
+    kernelMatvec(n, c0, c1, c2, numThreads, x, y);
+}
+
+void KernelOperator::applyTranspose(const Vector& x, Vector& y) const {
+    kernelMatvec(n, c0, c2, c1, numThreads, x, y);
+}
+
+void KernelOperator::diagonal(Vector& d) const {
+    d.resize(n);
+    for (int i = 0; i < n; ++i)
+        d[i] = entry(i, i);
+}
+
+bool KernelOperator::block(int i0, int j0, int m, int cols, Matrix& out) const {
+    out.assign(m, Vector(cols));
+    for (int i = 0; i < m; ++i)
+        for (int j = 0; j < cols; ++j)
+            out[i][j] = entry(i0 + i, j0 + j);
+    return true;
+}
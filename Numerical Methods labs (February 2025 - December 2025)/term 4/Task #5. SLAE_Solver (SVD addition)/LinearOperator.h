@@ -0,0 +1,74 @@
+#pragma once
+#include "LinearAlgebra.h"
+
+// Matrix-free access to a linear operator. Solvers written against this
+// interface never need the N x N matrix in memory.
+class LinearOperator {
+public:
+    virtual ~LinearOperator() = default;
+
+    virtual int rows() const = 0;
+    virtual int cols() const = 0;
+
+    // y = A * x
+    virtual void apply(const Vector& x, Vector& y) const = 0;
+    // y = A^T * x
+    virtual void applyTranspose(const Vector& x, Vector& y) const = 0;
+    virtual void diagonal(Vector& d) const = 0;
+
+    // Optional dense access: out = A[i0..i0+m)[j0..j0+n). Returns false if the
+    // operator cannot produce entries, callers then fall back to apply().
+    virtual bool block(int i0, int j0, int m, int n, Matrix& out) const {
+        (void)i0; (void)j0; (void)m; (void)n; (void)out;
+        return false;
+    }
+};
+
+// Wraps an already materialized matrix
+class DenseOperator : public LinearOperator {
+public:
+    explicit DenseOperator(const Matrix& A) : A(A) {}
+
+    int rows() const override { return A.size(); }
+    int cols() const override { return A[0].size(); }
+    void apply(const Vector& x, Vector& y) const override;
+    void applyTranspose(const Vector& x, Vector& y) const override;
+    void diagonal(Vector& d) const override;
+    bool block(int i0, int j0, int m, int n, Matrix& out) const override;
+
+private:
+    const Matrix& A;
+};
+
+// a_ij = 1 / (c0 + c1 * (i + 1) + c2 * (j + 1)), the defaults are the createMatrix kernel.
+// Entries are computed on the fly: the matvec is tiled over columns, vectorized
+// over j and split over rows between threads, memory stays O(N).
+class KernelOperator : public LinearOperator {
+public:
+    KernelOperator(int n, double c0 = 1.0, double c1 = 0.6, double c2 = 2.0, int numThreads = 0);
+
+    double entry(int i, int j) const { return 1.0 / (c0 + c1 * (i + 1) + c2 * (j + 1)); }
+
+    int rows() const override { return n; }
+    int cols() const override { return n; }
+    void apply(const Vector& x, Vector& y) const override;
+    void applyTranspose(const Vector& x, Vector& y) const override;
+    void diagonal(Vector& d) const override;
+    bool block(int i0, int j0, int m, int cols, Matrix& out) const override;
+
+private:
+    int n;
+    double c0, c1, c2;
+    int numThreads;
+};
+
+// Restarted GMRES with Jacobi (diagonal) right preconditioning
+Vector solveGMRES(const LinearOperator& A, const Vector& f, double tol = 1e-10,
+    int restart = 50, int maxIter = 1000, int* iterations = nullptr);
+
+// Adaptive cross approximation A ~ U * V^T (U is rows x r, V is cols x r)
+// built from single rows and columns of the operator
+int lowRankApproximation(const LinearOperator& A, double tol, int maxRank, Matrix& U, Matrix& V);
+
+// Minimum-norm least-squares solve through the ACA factors
+Vector solveLowRank(const LinearOperator& A, const Vector& f, double tol = 1e-10, int maxRank = 100);
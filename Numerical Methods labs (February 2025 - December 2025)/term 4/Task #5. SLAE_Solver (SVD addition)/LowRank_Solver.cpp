@@ -0,0 +1,140 @@
+#include "LinearOperator.h"
+#include <cmath>
+#include <algorithm>
+
+static void operatorRow(const LinearOperator& A, int i, Vector& row) {
+    Matrix tmp;
+    if (A.block(i, 0, 1, A.cols(), tmp)) {
+        row = std::move(tmp[0]);
+        return;
+    }
+    Vector e(A.rows(), 0.0);
+    e[i] = 1.0;
+    A.applyTranspose(e, row);
+}
+
+static void operatorColumn(const LinearOperator& A, int j, Vector& col) {
+    Matrix tmp;
+    if (A.block(0, j, A.rows(), 1, tmp)) {
+        col.resize(A.rows());
+        for (int i = 0; i < A.rows(); ++i)
+            col[i] = tmp[i][0];
+        return;
+    }
+    Vector e(A.cols(), 0.0);
+    e[j] = 1.0;
+    A.apply(e, col);
+}
+
+// ACA with partial pivoting (Bebendorf): each step reads one row and one column
+// of the residual, so the cost is O((m + n) * r^2) and A itself is never stored.
+int lowRankApproximation(const LinearOperator& A, double tol, int maxRank, Matrix& U, Matrix& V) {
+    int m = A.rows(), n = A.cols();
+    std::vector<Vector> us, vs;
+    std::vector<bool> usedRow(m, false);
+    double norm2 = 0.0;  // ||U V^T||_F^2
+    Vector row, col;
+
+    int i = 0;
+    while ((int)us.size() < std::min({ maxRank, m, n })) {
+        usedRow[i] = true;
+        operatorRow(A, i, row);
+        for (size_t k = 0; k < us.size(); ++k)
+            for (int j = 0; j < n; ++j)
+                row[j] -= us[k][i] * vs[k][j];
+
+        int jmax = 0;
+        for (int j = 1; j < n; ++j)
+            if (std::abs(row[j]) > std::abs(row[jmax])) jmax = j;
+
+        if (std::abs(row[jmax]) == 0.0) {
+            // Row is already reproduced, try the next unused one
+            int next = std::find(usedRow.begin(), usedRow.end(), false) - usedRow.begin();
+            if (next == m) break;
+            i = next;
+            continue;
+        }
+
+        double pivot = row[jmax];
+        for (int j = 0; j < n; ++j)
+            row[j] /= pivot;
+
+        operatorColumn(A, jmax, col);
+        for (size_t k = 0; k < us.size(); ++k)
+            for (int r = 0; r < m; ++r)
+                col[r] -= vs[k][jmax] * us[k][r];
+
+        double uu = 0.0, vv = 0.0;
+        for (int r = 0; r < m; ++r) uu += col[r] * col[r];
+        for (int j = 0; j < n; ++j) vv += row[j] * row[j];
+        for (size_t k = 0; k < us.size(); ++k) {
+            double uk = 0.0, vk = 0.0;
+            for (int r = 0; r < m; ++r) uk += us[k][r] * col[r];
+            for (int j = 0; j < n; ++j) vk += vs[k][j] * row[j];
+            norm2 += 2.0 * uk * vk;
+        }
+        norm2 += uu * vv;
+
+        us.push_back(col);
+        vs.push_back(row);
+        if (sqrt(uu * vv) <= tol * sqrt(norm2)) break;
+
+        // Next row: largest entry of the new column among unused rows
+        int next = -1;
+        for (int r = 0; r < m; ++r)
+            if (!usedRow[r] && (next < 0 || std::abs(col[r]) > std::abs(col[next]))) next = r;
+        if (next < 0) break;
+        i = next;
+    }
+
+    int rank = us.size();
+    U.assign(m, Vector(rank));
+    V.assign(n, Vector(rank));
+    for (int k = 0; k < rank; ++k) {
+        for (int r = 0; r < m; ++r) U[r][k] = us[k][r];
+        for (int j = 0; j < n; ++j) V[j][k] = vs[k][j];
+    }
+    return rank;
+}
+
+// Thin QR of a tall m x r matrix by modified Gram-Schmidt with reorthogonalization
+static void thinQR(Matrix& A, Matrix& R) {
+    int m = A.size(), r = A.empty() ? 0 : A[0].size();
+    R.assign(r, Vector(r, 0.0));
+    for (int k = 0; k < r; ++k) {
+        for (int pass = 0; pass < 2; ++pass)
+            for (int p = 0; p < k; ++p) {
+                double dot = 0.0;
+                for (int i = 0; i < m; ++i) dot += A[i][p] * A[i][k];
+                for (int i = 0; i < m; ++i) A[i][k] -= dot * A[i][p];
+                R[p][k] += dot;
+            }
+        double norm = 0.0;
+        for (int i = 0; i < m; ++i) norm += A[i][k] * A[i][k];
+        norm = sqrt(norm);
+        R[k][k] = norm;
+        if (norm > 0.0)
+            for (int i = 0; i < m; ++i) A[i][k] /= norm;
+    }
+}
+
+// A ~ U V^T = Qu (Ru Rv^T) Qv^T, the r x r core goes through the rank-revealing QR
+Vector solveLowRank(const LinearOperator& A, const Vector& f, double tol, int maxRank) {
+    Matrix U, V, Ru, Rv;
+    int r = lowRankApproximation(A, tol, maxRank, U, V);
+    Vector x(A.cols(), 0.0);
+    if (r == 0) return x;
+
+    thinQR(U, Ru);
+    thinQR(V, Rv);
+    Matrix core = multiply(Ru, Rv, false, true);
+    Vector c = multiply(U, f, true);
+
+    Vector tau, tauZ;
+    std::vector<int> jpvt;
+    int rank = pivotedQR(core, tau, jpvt);
+    completeOrthogonal(core, rank, tauZ);
+    Vector z = solveMinNormQR(core, tau, jpvt, rank, tauZ, c);
+
+    return multiply(V, z);
+}
@@ -1,45 +1,252 @@
 #include "LinearAlgebra.h"
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+const int TRANSPOSE_TILE = 32;        // 32 x 32 doubles = 8 KB per tile
+const int PARALLEL_MIN_ROWS = 256;    // smaller matrices are generated on one thread
+
+static int threadsFor(int rows) {
+    return rows < PARALLEL_MIN_ROWS ? 1 : defaultThreadCount();
+}
 
 Matrix createMatrix(int N) {
-    Matrix A(N, Vector(N));
-    for (int i = 0; i < N; ++i) {
-        for (int j = 0; j < N; ++j) {
-            A[i][j] = 1.0 / (1.0 + 0.6 * (i + 1) + 2.0 * (j + 1));
+    Matrix A(N);
+    parallelFor(0, N, threadsFor(N), [&](int lo, int hi) {
+        for (int i = lo; i < hi; ++i) {
+            A[i].resize(N);
+            for (int j = 0; j < N; ++j) {
+                A[i][j] = 1.0 / (1.0 + 0.6 * (i + 1) + 2.0 * (j + 1));
+            }
         }
-    }
+    });
     return A;
 }
 
-Vector createRightHandSide(const Matrix& A) {
+// Row sums split over rows; each row is still summed left to right,
+// so the result does not depend on the thread count
+Vector rowSums(const Matrix& A) {
     int N = A.size();
     Vector f(N, 0.0);
-    for (int i = 0; i < N; ++i) {
-        for (int j = 0; j < N; ++j) {
-            f[i] += A[i][j];
+    parallelFor(0, N, threadsFor(N), [&](int lo, int hi) {
+        for (int i = lo; i < hi; ++i) {
+            double sum = 0.0;
+            for (double a : A[i])
+                sum += a;
+            f[i] = sum;
         }
-    }
+    });
     return f;
 }
 
+Vector createRightHandSide(const Matrix& A) {
+    return rowSums(A);
+}
+
+// Micro-kernel: dst[0..MICRO)[dc..] = (src[0..MICRO)[sc..])^T, one register per row
+#if defined(__AVX__)
+const int MICRO = 4;
+static inline void microTranspose(const double* const* src, int sc, double* const* dst, int dc) {
+    __m256d r0 = _mm256_loadu_pd(src[0] + sc), r1 = _mm256_loadu_pd(src[1] + sc);
+    __m256d r2 = _mm256_loadu_pd(src[2] + sc), r3 = _mm256_loadu_pd(src[3] + sc);
+    __m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+    __m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+    _mm256_storeu_pd(dst[0] + dc, _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst[1] + dc, _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst[2] + dc, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst[3] + dc, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+const int MICRO = 2;
+static inline void microTranspose(const double* const* src, int sc, double* const* dst, int dc) {
+    __m128d r0 = _mm_loadu_pd(src[0] + sc), r1 = _mm_loadu_pd(src[1] + sc);
+    _mm_storeu_pd(dst[0] + dc, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(dst[1] + dc, _mm_unpackhi_pd(r0, r1));
+}
+#else
+const int MICRO = 1;
+static inline void microTranspose(const double* const* src, int sc, double* const* dst, int dc) {
+    dst[0][dc] = src[0][sc];
+}
+#endif
+
+// dst[c0 + c][r0 + r] = src[r0 + r][c0 + c] for one tile
+static void transposeTile(const double* const* src, int r0, int rows,
+    double* const* dst, int c0, int cols) {
+    int rm = rows - rows % MICRO, cm = cols - cols % MICRO;
+    for (int r = 0; r < rm; r += MICRO)
+        for (int c = 0; c < cm; c += MICRO)
+            microTranspose(src + r, c0 + c, dst + c, r0 + r);
+
+    // Ragged edges
+    for (int r = 0; r < rows; ++r)
+        for (int c = (r < rm ? cm : 0); c < cols; ++c)
+            dst[c][r0 + r] = src[r][c0 + c];
+}
+
+// Tiled transpose: threads own disjoint row blocks of At, every tile is read
+// and written through the SIMD micro-kernel
 Matrix transpose(const Matrix& A) {
     int m = A.size(), n = A[0].size();
     Matrix At(n, Vector(m));
-    for (int i = 0; i < m; ++i)
-        for (int j = 0; j < n; ++j)
-            At[j][i] = A[i][j];
+
+    int tilesN = (n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    parallelFor(0, tilesN, threadsFor(std::max(m, n)), [&](int lo, int hi) {
+        const double* src[TRANSPOSE_TILE];
+        double* dst[TRANSPOSE_TILE];
+        for (int J = lo; J < hi; ++J) {
+            int c0 = J * TRANSPOSE_TILE, cols = std::min(TRANSPOSE_TILE, n - c0);
+            for (int c = 0; c < cols; ++c) dst[c] = At[c0 + c].data();
+            for (int r0 = 0; r0 < m; r0 += TRANSPOSE_TILE) {
+                int rows = std::min(TRANSPOSE_TILE, m - r0);
+                for (int r = 0; r < rows; ++r) src[r] = A[r0 + r].data();
+                transposeTile(src, r0, rows, dst, c0, cols);
+            }
+        }
+    });
     return At;
 }
 
-Matrix multiply(const Matrix& A, const Matrix& B) {
-    int m = A.size(), n = B[0].size(), p = B.size();
+// In-place transpose of a square matrix: tile pairs (I, J) and (J, I) are
+// swapped through a stack buffer, the pairs are spread evenly over threads
+void transposeInPlace(Matrix& A) {
+    int n = A.size();
+    int nt = (n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    std::vector<std::pair<int, int>> pairs;
+    for (int I = 0; I < nt; ++I)
+        for (int J = I; J < nt; ++J)
+            pairs.emplace_back(I, J);
+
+    parallelFor(0, (int)pairs.size(), threadsFor(n), [&](int lo, int hi) {
+        double buffer[TRANSPOSE_TILE * TRANSPOSE_TILE];
+        const double* src[TRANSPOSE_TILE];
+        double* dst[TRANSPOSE_TILE];
+        for (int p = lo; p < hi; ++p) {
+            int r0 = pairs[p].first * TRANSPOSE_TILE, c0 = pairs[p].second * TRANSPOSE_TILE;
+            int rows = std::min(TRANSPOSE_TILE, n - r0), cols = std::min(TRANSPOSE_TILE, n - c0);
+
+            // buffer = tile (J, I)
+            for (int c = 0; c < cols; ++c)
+                std::copy(A[c0 + c].begin() + r0, A[c0 + c].begin() + r0 + rows, buffer + c * rows);
+
+            // tile (J, I) = tile (I, J)^T; for diagonal tiles this overwrites the source,
+            // which is fine because the source is already saved in the buffer
+            if (r0 != c0) {
+                for (int r = 0; r < rows; ++r) src[r] = A[r0 + r].data();
+                for (int c = 0; c < cols; ++c) dst[c] = A[c0 + c].data();
+                transposeTile(src, r0, rows, dst, c0, cols);
+            }
+
+            // tile (I, J) = buffer^T
+            for (int c = 0; c < cols; ++c) src[c] = buffer + c * rows;
+            for (int r = 0; r < rows; ++r) dst[r] = A[r0 + r].data();
+            transposeTile(src, c0, cols, dst, 0, rows);
+        }
+    });
+}
+
+// C = op(A) * op(B), op(X) = X or X^T. Transposed operands are read in place,
+// loop orders keep the innermost access contiguous for every combination
+// (A^T * B^T is formed as (B * A)^T, so it pays for one transpose of C).
+Matrix multiply(const Matrix& A, const Matrix& B, bool transA, bool transB) {
+    int m = transA ? A[0].size() : A.size();
+    int p = transA ? A.size() : A[0].size();
+    int n = transB ? B.size() : B[0].size();
     Matrix C(m, Vector(n, 0));
-    for (int i = 0; i < m; ++i)
+
+    if (!transA && !transB) {
+        for (int i = 0; i < m; ++i)
+            for (int k = 0; k < p; ++k) {
+                double a = A[i][k];
+                for (int j = 0; j < n; ++j)
+                    C[i][j] += a * B[k][j];
+            }
+    }
+    else if (transA && !transB) {
+        for (int k = 0; k < p; ++k)
+            for (int i = 0; i < m; ++i) {
+                double a = A[k][i];
+                for (int j = 0; j < n; ++j)
+                    C[i][j] += a * B[k][j];
+            }
+    }
+    else if (!transA && transB) {
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < p; ++k)
+                    sum += A[i][k] * B[j][k];
+                C[i][j] = sum;
+            }
+    }
+    else {
+        Matrix Ct(n, Vector(m, 0));
         for (int j = 0; j < n; ++j)
-            for (int k = 0; k < p; ++k)
-                C[i][j] += A[i][k] * B[k][j];
+            for (int k = 0; k < p; ++k) {
+                double b = B[j][k];
+                for (int i = 0; i < m; ++i)
+                    Ct[j][i] += b * A[k][i];
+            }
+        C = transpose(Ct);
+    }
+    return C;
+}
+
+// Symmetric rank-k product: A^T * A (trans) or A * A^T. Only the upper triangle
+// is computed, the lower one is mirrored from it.
+Matrix syrk(const Matrix& A, bool trans) {
+    int rows = A.size(), cols = A[0].size();
+    int n = trans ? cols : rows;
+    Matrix C(n, Vector(n, 0.0));
+
+    if (trans) {
+        for (int k = 0; k < rows; ++k) {
+            const Vector& a = A[k];
+            for (int i = 0; i < n; ++i) {
+                double aki = a[i];
+                if (aki == 0.0) continue;
+                for (int j = i; j < n; ++j)
+                    C[i][j] += aki * a[j];
+            }
+        }
+    }
+    else {
+        for (int i = 0; i < n; ++i)
+            for (int j = i; j < n; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < cols; ++k)
+                    sum += A[i][k] * A[j][k];
+                C[i][j] = sum;
+            }
+    }
+
+    for (int i = 0; i < n; ++i)
+        for (int j = 0; j < i; ++j)
+            C[i][j] = C[j][i];
     return C;
 }
 
+// y = op(A) * x
+Vector multiply(const Matrix& A, const Vector& x, bool transA) {
+    int m = A.size(), n = A[0].size();
+    Vector y(transA ? n : m, 0.0);
+    if (transA) {
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j)
+                y[j] += A[i][j] * x[i];
+    }
+    else {
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j)
+                y[i] += A[i][j] * x[j];
+    }
+    return y;
+}
+
 double computeError(const Vector& x, const Vector& x_exact) {
     double diff_norm = 0.0;
     double exact_norm = 0.0;
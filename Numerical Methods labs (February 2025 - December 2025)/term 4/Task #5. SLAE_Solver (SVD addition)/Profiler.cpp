@@ -0,0 +1,153 @@
+#include "Profiler.h"
+
+#ifdef SLAE_PROFILE
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Profiler {
+    namespace {
+        struct Stat {
+            long long totalNs = 0;
+            long long calls = 0;
+        };
+
+        struct Event {
+            const char* name;
+            long long startNs;
+            long long durationNs;
+        };
+
+        // One table per thread, only its owner writes to it. Name pointers are
+        // string literals, equal names from different files are merged by value.
+        struct ThreadData {
+            int tid = 0;
+            std::unordered_map<const char*, Stat> timers;
+            std::unordered_map<const char*, long long> counters;
+            std::vector<Event> events;
+        };
+
+        struct Registry {
+            std::mutex lock;
+            std::vector<std::shared_ptr<ThreadData>> threads;
+            Clock::time_point epoch = Clock::now();
+            std::atomic<bool> trace{ false };
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        ThreadData& local() {
+            thread_local std::shared_ptr<ThreadData> data = [] {
+                auto created = std::make_shared<ThreadData>();
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> guard(reg.lock);
+                created->tid = reg.threads.size();
+                reg.threads.push_back(created);
+                return created;
+            }();
+            return *data;
+        }
+
+        long long toNs(Clock::duration d) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        }
+    }
+
+    void record(const char* name, Clock::time_point start, Clock::time_point stop) {
+        ThreadData& data = local();
+        Stat& stat = data.timers[name];
+        stat.totalNs += toNs(stop - start);
+        stat.calls += 1;
+        if (registry().trace.load(std::memory_order_relaxed))
+            data.events.push_back({ name, toNs(start - registry().epoch), toNs(stop - start) });
+    }
+
+    void count(const char* name, long long value) {
+        local().counters[name] += value;
+    }
+
+    void enableTrace(bool enabled) {
+        registry().trace.store(enabled);
+    }
+
+    // Reports are meant to be written after the measured work has finished
+    void report(std::ostream& out) {
+        std::map<std::string, Stat> timers;
+        std::map<std::string, long long> counters;
+        {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> guard(reg.lock);
+            for (auto& data : reg.threads) {
+                for (auto& entry : data->timers) {
+                    Stat& stat = timers[entry.first];
+                    stat.totalNs += entry.second.totalNs;
+                    stat.calls += entry.second.calls;
+                }
+                for (auto& entry : data->counters)
+                    counters[entry.first] += entry.second;
+            }
+        }
+
+        auto flags = out.flags();
+        out << std::left << std::setw(32) << "Phase" << std::right << std::setw(14) << "Total, us"
+            << std::setw(12) << "Calls" << std::setw(14) << "Mean, us" << std::endl;
+        out << std::string(72, '-') << std::endl;
+        out << std::fixed << std::setprecision(1);
+        for (auto& entry : timers) {
+            double total = entry.second.totalNs / 1000.0;
+            out << std::left << std::setw(32) << entry.first << std::right << std::setw(14) << total
+                << std::setw(12) << entry.second.calls
+                << std::setw(14) << total / std::max(1LL, entry.second.calls) << std::endl;
+        }
+        if (!counters.empty()) {
+            out << std::string(72, '-') << std::endl;
+            for (auto& entry : counters)
+                out << std::left << std::setw(32) << entry.first << std::right << std::setw(14)
+                    << entry.second << std::endl;
+        }
+        out.flags(flags);
+    }
+
+    bool writeChromeTrace(const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file) return false;
+
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+        bool first = true;
+        for (auto& data : reg.threads) {
+            for (const Event& e : data->events) {
+                file << (first ? "" : ",") << "\n{\"name\":\"" << e.name << "\",\"ph\":\"X\""
+                    << ",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0
+                    << ",\"pid\":0,\"tid\":" << data->tid << "}";
+                first = false;
+            }
+        }
+        file << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        return true;
+    }
+
+    void reset() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        for (auto& data : reg.threads) {
+            data->timers.clear();
+            data->counters.clear();
+            data->events.clear();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+// Phase timers and counters for the solvers.
+// Built with SLAE_PROFILE defined, every PROFILE_* macro records into per-thread
+// tables that are merged when a report is written; without it the macros expand
+// to nothing and the solvers carry no extra code.
+//
+//   PROFILE_SCOPE("lu.pivot_search");      // time until the end of the scope
+//   PROFILE_COUNT("lu.row_swaps", 1);      // add to a counter
+//   PROFILE_TRACE_EVENTS(true);            // also keep every scope for the trace
+//   PROFILE_REPORT(std::cout);             // per-phase totals and call counts
+//   PROFILE_WRITE_TRACE("trace.json");     // Chrome trace (chrome://tracing, Perfetto)
+
+#ifdef SLAE_PROFILE
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace Profiler {
+    using Clock = std::chrono::steady_clock;
+
+    void record(const char* name, Clock::time_point start, Clock::time_point stop);
+    void count(const char* name, long long value);
+    void enableTrace(bool enabled);
+    void report(std::ostream& out);
+    bool writeChromeTrace(const std::string& filename);
+    void reset();
+
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(const char* name) : name(name), start(Clock::now()) {}
+        ~ScopedTimer() { record(name, start, Clock::now()); }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        const char* name;
+        Clock::time_point start;
+    };
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) Profiler::ScopedTimer PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_COUNT(name, value) Profiler::count(name, value)
+#define PROFILE_TRACE_EVENTS(enabled) Profiler::enableTrace(enabled)
+#define PROFILE_REPORT(stream) Profiler::report(stream)
+#define PROFILE_WRITE_TRACE(filename) Profiler::writeChromeTrace(filename)
+#define PROFILE_RESET() Profiler::reset()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_COUNT(name, value) ((void)0)
+#define PROFILE_TRACE_EVENTS(enabled) ((void)0)
+#define PROFILE_REPORT(stream) ((void)0)
+#define PROFILE_WRITE_TRACE(filename) ((void)0)
+#define PROFILE_RESET() ((void)0)
+
+#endif
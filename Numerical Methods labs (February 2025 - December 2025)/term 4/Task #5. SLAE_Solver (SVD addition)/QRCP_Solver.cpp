@@ -0,0 +1,275 @@
+#include "LinearAlgebra.h"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+const int QP3_BLOCK = 32;             // panel width of the blocked factorization
+const double QP3_THRESHOLD = 1e-10;   // same relative tolerance as SVD truncation
+
+// Householder reflector H = I - tau * v * v^T that zeros A[k+1..m-1][col].
+// v[k] = 1 is implicit, the rest of v overwrites the zeroed part of the column.
+static double makeReflector(Matrix& A, int k, int col, int m) {
+    double alpha = A[k][col];
+    double sigma = 0.0;
+    for (int i = k + 1; i < m; ++i)
+        sigma += A[i][col] * A[i][col];
+    if (sigma == 0.0) return 0.0;
+
+    double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+    double scale = 1.0 / (alpha - beta);
+    for (int i = k + 1; i < m; ++i)
+        A[i][col] *= scale;
+    A[k][col] = beta;
+    return (beta - alpha) / beta;
+}
+
+static double columnNorm(const Matrix& A, int from, int col) {
+    double norm = 0.0;
+    for (int i = from; i < (int)A.size(); ++i)
+        norm += A[i][col] * A[i][col];
+    return sqrt(norm);
+}
+
+// One panel of QP3 (LAPACK xLAQPS scheme). Columns of the trailing matrix are
+// updated lazily through F = tau * A^T * V, so the only per-column work inside
+// the panel is the pivot row; the rest of the trailing matrix gets a single
+// rank-kb update at the end. Returns the number of columns factored.
+static int qp3Panel(Matrix& A, int s, int nb, Vector& tau, std::vector<int>& jpvt,
+    Vector& vn1, Vector& vn2, Matrix& F) {
+    int m = A.size(), n = A[0].size();
+    int lastrk = std::min(m, n) - 1;
+    const double tol3z = sqrt(std::numeric_limits<double>::epsilon());
+    std::vector<int> recompute;
+
+    int k = 0;
+    while (k < nb && recompute.empty()) {
+        int rk = s + k;
+
+        // Column pivoting by the largest partial norm
+        int pvt = rk;
+        for (int j = rk + 1; j < n; ++j)
+            if (vn1[j] > vn1[pvt]) pvt = j;
+        if (pvt != rk) {
+            for (int i = 0; i < m; ++i)
+                std::swap(A[i][pvt], A[i][rk]);
+            std::swap(F[pvt], F[rk]);
+            std::swap(jpvt[pvt], jpvt[rk]);
+            vn1[pvt] = vn1[rk];
+            vn2[pvt] = vn2[rk];
+        }
+
+        // Apply the previous reflectors of the panel to column rk
+        for (int i = rk; i < m; ++i) {
+            double sum = 0.0;
+            for (int c = 0; c < k; ++c)
+                sum += A[i][s + c] * F[rk][c];
+            A[i][rk] -= sum;
+        }
+
+        tau[rk] = (rk < m - 1) ? makeReflector(A, rk, rk, m) : 0.0;
+        double akk = A[rk][rk];
+        A[rk][rk] = 1.0;
+
+        // k-th column of F
+        for (int j = s; j <= rk; ++j)
+            F[j][k] = 0.0;
+        for (int j = rk + 1; j < n; ++j) {
+            double dot = 0.0;
+            for (int i = rk; i < m; ++i)
+                dot += A[i][j] * A[i][rk];
+            F[j][k] = tau[rk] * dot;
+        }
+
+        // Incremental update of F for the reflectors already in the panel
+        if (k > 0) {
+            Vector aux(k, 0.0);
+            for (int c = 0; c < k; ++c) {
+                for (int i = rk; i < m; ++i)
+                    aux[c] += A[i][s + c] * A[i][rk];
+                aux[c] *= -tau[rk];
+            }
+            for (int j = s; j < n; ++j)
+                for (int c = 0; c < k; ++c)
+                    F[j][k] += F[j][c] * aux[c];
+        }
+
+        // Pivot row of the trailing matrix
+        for (int j = rk + 1; j < n; ++j) {
+            double sum = 0.0;
+            for (int c = 0; c <= k; ++c)
+                sum += A[rk][s + c] * F[j][c];
+            A[rk][j] -= sum;
+        }
+
+        // Downdate partial column norms, flag the ones that lost accuracy
+        if (rk < lastrk) {
+            for (int j = rk + 1; j < n; ++j) {
+                if (vn1[j] == 0.0) continue;
+                double temp = fabs(A[rk][j]) / vn1[j];
+                temp = std::max(0.0, (1.0 + temp) * (1.0 - temp));
+                double ratio = vn1[j] / vn2[j];
+                if (temp * ratio * ratio <= tol3z)
+                    recompute.push_back(j);
+                else
+                    vn1[j] *= sqrt(temp);
+            }
+        }
+
+        A[rk][rk] = akk;
+        ++k;
+    }
+
+    // Block update of the trailing matrix: A22 -= V * F^T
+    int last = s + k;
+    if (last < std::min(m, n)) {
+        for (int i = last; i < m; ++i) {
+            for (int j = last; j < n; ++j) {
+                double sum = 0.0;
+                for (int c = 0; c < k; ++c)
+                    sum += A[i][s + c] * F[j][c];
+                A[i][j] -= sum;
+            }
+        }
+    }
+
+    for (int j : recompute) {
+        vn1[j] = columnNorm(A, last, j);
+        vn2[j] = vn1[j];
+    }
+    return k;
+}
+
+int pivotedQR(Matrix& A, Vector& tau, std::vector<int>& jpvt) {
+    int m = A.size();
+    if (m == 0) return 0;
+    int n = A[0].size();
+    int k = std::min(m, n);
+
+    jpvt.resize(n);
+    for (int j = 0; j < n; ++j) jpvt[j] = j;
+    tau.assign(k, 0.0);
+
+    Vector vn1(n), vn2(n);
+    for (int j = 0; j < n; ++j) {
+        vn1[j] = columnNorm(A, 0, j);
+        vn2[j] = vn1[j];
+    }
+
+    Matrix F(n, Vector(QP3_BLOCK, 0.0));
+    for (int j = 0; j < k; ) {
+        int nb = std::min(QP3_BLOCK, k - j);
+        j += qp3Panel(A, j, nb, tau, jpvt, vn1, vn2, F);
+    }
+
+    // Numerical rank: |R_ii| is nonincreasing, cut it like solveSVD does
+    double threshold = fabs(A[0][0]) * std::max(m, n) * QP3_THRESHOLD;
+    int rank = 0;
+    while (rank < k && fabs(A[rank][rank]) > threshold)
+        ++rank;
+    return rank;
+}
+
+// [R11 R12] = [T11 0] * Z (LAPACK xTZRZF), T11 upper triangular.
+// Reflector i has 1 in position i and its tail in columns rank..n-1 of row i.
+void completeOrthogonal(Matrix& QR, int rank, Vector& tauZ) {
+    int n = QR[0].size();
+    tauZ.assign(rank, 0.0);
+    if (rank == n) return;
+
+    for (int i = rank - 1; i >= 0; --i) {
+        double alpha = QR[i][i];
+        double sigma = 0.0;
+        for (int j = rank; j < n; ++j)
+            sigma += QR[i][j] * QR[i][j];
+        if (sigma == 0.0) continue;
+
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        double scale = 1.0 / (alpha - beta);
+        for (int j = rank; j < n; ++j)
+            QR[i][j] *= scale;
+        QR[i][i] = beta;
+        tauZ[i] = (beta - alpha) / beta;
+
+        // Apply the reflector from the right to the rows above
+        for (int p = 0; p < i; ++p) {
+            double w = QR[p][i];
+            for (int j = rank; j < n; ++j)
+                w += QR[p][j] * QR[i][j];
+            w *= tauZ[i];
+            QR[p][i] -= w;
+            for (int j = rank; j < n; ++j)
+                QR[p][j] -= w * QR[i][j];
+        }
+    }
+}
+
+// y = Q^T * f with Q stored as reflectors below the diagonal
+static Vector applyQt(const Matrix& QR, const Vector& tau, const Vector& f) {
+    int m = QR.size();
+    Vector y = f;
+    for (int c = 0; c < (int)tau.size(); ++c) {
+        if (tau[c] == 0.0) continue;
+        double dot = y[c];
+        for (int i = c + 1; i < m; ++i)
+            dot += QR[i][c] * y[i];
+        dot *= tau[c];
+        y[c] -= dot;
+        for (int i = c + 1; i < m; ++i)
+            y[i] -= dot * QR[i][c];
+    }
+    return y;
+}
+
+// Basic solution: R11 * z = (Q^T f)[0..rank), free variables set to zero
+Vector solvePivotedQR(const Matrix& QR, const Vector& tau, const std::vector<int>& jpvt,
+    int rank, const Vector& f) {
+    int n = QR[0].size();
+    Vector y = applyQt(QR, tau, f);
+
+    Vector z(n, 0.0);
+    for (int i = rank - 1; i >= 0; --i) {
+        z[i] = y[i];
+        for (int j = i + 1; j < rank; ++j)
+            z[i] -= QR[i][j] * z[j];
+        z[i] /= QR[i][i];
+    }
+
+    Vector x(n, 0.0);
+    for (int j = 0; j < n; ++j)
+        x[jpvt[j]] = z[j];
+    return x;
+}
+
+// Minimum-norm solution, QR must already be reduced by completeOrthogonal
+Vector solveMinNormQR(const Matrix& QR, const Vector& tau, const std::vector<int>& jpvt,
+    int rank, const Vector& tauZ, const Vector& f) {
+    int n = QR[0].size();
+    Vector y = applyQt(QR, tau, f);
+
+    // T11 * w = y[0..rank)
+    Vector z(n, 0.0);
+    for (int i = rank - 1; i >= 0; --i) {
+        z[i] = y[i];
+        for (int j = i + 1; j < rank; ++j)
+            z[i] -= QR[i][j] * z[j];
+        z[i] /= QR[i][i];
+    }
+
+    // z = Z^T * [w; 0]
+    for (int i = 0; i < rank; ++i) {
+        if (tauZ[i] == 0.0) continue;
+        double dot = z[i];
+        for (int j = rank; j < n; ++j)
+            dot += QR[i][j] * z[j];
+        dot *= tauZ[i];
+        z[i] -= dot;
+        for (int j = rank; j < n; ++j)
+            z[j] -= dot * QR[i][j];
+    }
+
+    Vector x(n, 0.0);
+    for (int j = 0; j < n; ++j)
+        x[jpvt[j]] = z[j];
+    return x;
+}
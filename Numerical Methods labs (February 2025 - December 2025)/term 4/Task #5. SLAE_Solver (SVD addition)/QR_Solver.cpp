@@ -1,69 +1,85 @@
 #include "LinearAlgebra.h"
+#include "Profiler.h"
+#include "FixedMatrix.h"
 #include <cmath>
 #include <iostream>
 
+// reflection vector calculation for column k of R, false if the column is already zero
+static bool householderVector(const Matrix& R, int k, Vector& v, double& beta) {
+    int n = R.size();
+    double norm = 0.0;
+    for (int i = k; i < n; ++i)
+        norm += R[i][k] * R[i][k];
+    norm = sqrt(norm);
+
+    // if norm ~ 0 then in beta calculation there is zero devision
+    if (fabs(norm) < 1e-12) return false;
+
+    double alpha = -copysign(norm, R[k][k]);
+    v.assign(n, 0.0);
+    for (int i = k; i < n; ++i)
+        if (i == k) {
+            v[i] = R[i][k] - alpha;
+        }
+        else {
+            v[i] = R[i][k];
+        }
+
+    beta = 0.0;
+    for (int i = k; i < n; ++i)
+        beta += v[i] * v[i];
+    beta = 2.0 / beta;
+    return true;
+}
+
 void householderQR(const Matrix& A, Matrix& Q, Matrix& R) {
+    PROFILE_SCOPE("qr.factor");
     int n = A.size();
     Q = Matrix(n, Vector(n, 0.0));
     for (int i = 0; i < n; ++i) Q[i][i] = 1.0;
     R = A;
 
     for (int k = 0; k < n - 1; ++k) {
-        // reflection vector calculation 
-        double norm = 0.0;
-        for (int i = k; i < n; ++i)
-            norm += R[i][k] * R[i][k];
-        norm = sqrt(norm);
-
-        // if norm ~ 0 then in beta calculation there is zero devision
-        if (fabs(norm) < 1e-12) continue;
-
-        double alpha = -copysign(norm, R[k][k]);
-        Vector v(n, 0.0);
-        for (int i = k; i < n; ++i)
-            if (i == k) {
-                v[i] = R[i][k] - alpha;
-            }
-            else {
-                v[i] = R[i][k];
-            }
-
-        double beta = 0.0;
-        for (int i = k; i < n; ++i)
-            beta += v[i] * v[i];
-        beta = 2.0 / beta;
+        Vector v;
+        double beta;
+        {
+            PROFILE_SCOPE("qr.reflector");
+            if (!householderVector(R, k, v, beta)) continue;
+        }
 
         // R update
-        for (int j = k; j < n; ++j) {
-            double dot = 0.0;
-            for (int i = k; i < n; ++i)
-                dot += v[i] * R[i][j];
-            for (int i = k; i < n; ++i)
-                R[i][j] -= beta * v[i] * dot;
+        {
+            PROFILE_SCOPE("qr.update_R");
+            for (int j = k; j < n; ++j) {
+                double dot = 0.0;
+                for (int i = k; i < n; ++i)
+                    dot += v[i] * R[i][j];
+                for (int i = k; i < n; ++i)
+                    R[i][j] -= beta * v[i] * dot;
+            }
         }
 
         // Q update
-        for (int j = 0; j < n; ++j) {
-            double dot = 0.0;
-            for (int i = k; i < n; ++i)
-                dot += Q[j][i] * v[i];
-            for (int i = k; i < n; ++i)
-                Q[j][i] -= beta * v[i] * dot;
+        {
+            PROFILE_SCOPE("qr.accumulate_Q");
+            for (int j = 0; j < n; ++j) {
+                double dot = 0.0;
+                for (int i = k; i < n; ++i)
+                    dot += Q[j][i] * v[i];
+                for (int i = k; i < n; ++i)
+                    Q[j][i] -= beta * v[i] * dot;
+            }
         }
     }
 }
 
 
 Vector solveQR(const Matrix& Q, const Matrix& R, const Vector& f) {
+    PROFILE_SCOPE("qr.solve");
     int N = Q.size();
 
     // Compute Q^T * f  (Q is orthogonal, so Q^T = Q^H = Q.transpose())
-    Vector y(N, 0.0);
-    for (int i = 0; i < N; ++i) {
-        for (int j = 0; j < N; ++j) {
-            y[i] += Q[j][i] * f[j];
-        }
-    }
+    Vector y = multiply(Q, f, true);
 
     // Back substitution for Rx = y
     Vector x(N, 0.0);
@@ -76,4 +92,36 @@ Vector solveQR(const Matrix& Q, const Matrix& R, const Vector& f) {
     }
 
     return x;
+}
+
+template <int N>
+static Vector solveFixedQR(const Matrix& A, const Vector& f) {
+    FixedMatrix<N> a;
+    FixedVector<N> b, tau;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j)
+            a[i][j] = A[i][j];
+        b[i] = f[i];
+    }
+    qr<N>(a, tau);
+    FixedVector<N> x = solveQR<N>(a, tau, b);
+    return Vector(x.begin(), x.end());
+}
+
+// QR solve of A; the common small sizes go to the unrolled fixed-size kernels
+Vector solveDirectQR(const Matrix& A, const Vector& f) {
+    switch (A.size()) {
+    case 3: return solveFixedQR<3>(A, f);
+    case 4: return solveFixedQR<4>(A, f);
+    case 5: return solveFixedQR<5>(A, f);
+    case 6: return solveFixedQR<6>(A, f);
+    case 8: return solveFixedQR<8>(A, f);
+    case 10: return solveFixedQR<10>(A, f);
+    case 20: return solveFixedQR<20>(A, f);
+    default: {
+        Matrix Q, R;
+        householderQR(A, Q, R);
+        return solveQR(Q, R, f);
+    }
+    }
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "LinearAlgebra.h"
+#include "Profiler.h"
 #include <vector>
 #include <cmath>
 #include <algorithm>
@@ -9,6 +10,7 @@ const double SVD_THRESHOLD = 1e-10;
 
 // Calculating eigen values using QR decomposition
 void computeEigenvalues(const Matrix& A, Vector& eigenvalues, Matrix& eigenvectors) {
+    PROFILE_SCOPE("eig.total");
     int n = A.size();
     Matrix Ak = A;
     Matrix Q, R;
@@ -21,12 +23,20 @@ void computeEigenvalues(const Matrix& A, Vector& eigenvalues, Matrix& eigenvecto
         
         householderQR(Ak, Q, R);
 
-        Ak = multiply(R, Q);
+        {
+            PROFILE_SCOPE("eig.RQ");
+            Ak = multiply(R, Q);
+        }
 
-        Matrix temp = multiply(eigenvectors, Q);
-        eigenvectors = temp;
+        {
+            PROFILE_SCOPE("eig.accumulate_V");
+            Matrix temp = multiply(eigenvectors, Q);
+            eigenvectors = temp;
+        }
+        PROFILE_COUNT("eig.iterations", 1);
     }
 
+    PROFILE_SCOPE("eig.sort");
     eigenvalues.resize(n);
     for (int i = 0; i < n; ++i) {
         eigenvalues[i] = Ak[i][i];
@@ -43,19 +53,23 @@ void computeEigenvalues(const Matrix& A, Vector& eigenvalues, Matrix& eigenvecto
     }
 }
 
-void svdDecomposition(const Matrix& A, Matrix& U, Vector& S, Matrix& Vt) {
+// A = U * diag(S) * V^T, the right singular vectors are the columns of V
+void svdDecomposition(const Matrix& A, Matrix& U, Vector& S, Matrix& V) {
+    PROFILE_SCOPE("svd.factor");
     int m = A.size();
     if (m == 0) return;
     int n = A[0].size();
     int k = std::min(m, n);
 
-    // 1. Calculating AtA
-    Matrix At = transpose(A);
-    Matrix AtA = multiply(At, A);
+    // 1. Calculating AtA (one triangle, straight from A)
+    Matrix AtA;
+    {
+        PROFILE_SCOPE("svd.AtA");
+        AtA = syrk(A);
+    }
 
     // 2. Calculating AtA's eigen values using QR decomposition
     Vector eigenvalues;
-    Matrix V;
     computeEigenvalues(AtA, eigenvalues, V);
 
     // 3. Singular number - root of eigen number
@@ -64,22 +78,28 @@ void svdDecomposition(const Matrix& A, Matrix& U, Vector& S, Matrix& Vt) {
         S[i] = sqrt(fabs(eigenvalues[i]));
     }
 
-    // 4. Calculating Vt
-    Vt = transpose(V);
-
-    // 5. Calculating U like A*V*diag(S)^(-1)
+    // 4. Calculating U like A*V*diag(S)^(-1), V is read row by row (i-l-j order)
+    PROFILE_SCOPE("svd.U");
+    Vector invS(k, 0.0);
+    for (int j = 0; j < k; ++j) {
+        if (S[j] > SVD_EPS) {
+            invS[j] = 1.0 / S[j];
+        }
+    }
     U = Matrix(m, Vector(k, 0.0));
     for (int i = 0; i < m; ++i) {
-        for (int j = 0; j < k; ++j) {
-            if (S[j] > SVD_EPS) {
-                for (int l = 0; l < n; ++l) {
-                    U[i][j] += A[i][l] * Vt[j][l] / S[j];
-                }
+        for (int l = 0; l < n; ++l) {
+            double a = A[i][l];
+            for (int j = 0; j < k; ++j) {
+                U[i][j] += a * V[l][j];
             }
         }
+        for (int j = 0; j < k; ++j) {
+            U[i][j] *= invS[j];
+        }
     }
 
-    // 6. New U's columns normalization
+    // 5. New U's columns normalization
     for (int j = 0; j < k; ++j) {
 
         // first normalization
@@ -108,22 +128,18 @@ void svdDecomposition(const Matrix& A, Matrix& U, Vector& S, Matrix& Vt) {
 }
 
 
-Vector solveSVD(const Matrix& U, const Vector& S, const Matrix& Vt, const Vector& f) {
+Vector solveSVD(const Matrix& U, const Vector& S, const Matrix& V, const Vector& f) {
+    PROFILE_SCOPE("svd.solve");
     int m = U.size();
-    int n = Vt[0].size();
+    int n = V.size();
 
     // 1. Ut * f
-    Vector y(m, 0.0);
-    for (int i = 0; i < m; ++i) {
-        for (int j = 0; j < m; ++j) {
-            y[i] += U[j][i] * f[j];
-        }
-    }
+    Vector y = multiply(U, f, true);
 
     // 2. diag(S)^(-1) * (Ut * f)
     double max_s = *std::max_element(S.begin(), S.end());
     double threshold = max_s * std::max(m, n) * SVD_THRESHOLD;
-    for (int i = 0; i < S.size(); ++i) {
+    for (int i = 0; i < (int)S.size(); ++i) {
         if (S[i] > threshold) {
             y[i] /= S[i];
         }
@@ -134,9 +150,10 @@ Vector solveSVD(const Matrix& U, const Vector& S, const Matrix& Vt, const Vector
 
     // 3. V * (diag(S)^(-1) * Ut * f)
     Vector x(n, 0.0);
+    int k = y.size();
     for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            x[i] += Vt[j][i] * (j < y.size() ? y[j] : 0.0);
+        for (int j = 0; j < k; ++j) {
+            x[i] += V[i][j] * y[j];
         }
     }
 
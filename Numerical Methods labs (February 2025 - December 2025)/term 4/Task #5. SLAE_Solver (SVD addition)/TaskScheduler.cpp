@@ -0,0 +1,205 @@
+#include "TaskScheduler.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <exception>
+
+void TaskGraph::addTask(std::function<void()> kernel,
+    const std::vector<const void*>& reads,
+    const std::vector<const void*>& writes,
+    bool critical) {
+    int id = tasks.size();
+    tasks.emplace_back();
+    Task& task = tasks.back();
+    task.kernel = std::move(kernel);
+    task.critical = critical;
+
+    std::vector<int> preds;
+    for (const void* handle : reads) {
+        Access& access = accesses[handle];
+        if (access.lastWriter >= 0) preds.push_back(access.lastWriter);      // RAW
+        access.readers.push_back(id);
+    }
+    for (const void* handle : writes) {
+        Access& access = accesses[handle];
+        if (access.lastWriter >= 0) preds.push_back(access.lastWriter);      // WAW
+        for (int reader : access.readers)
+            if (reader != id) preds.push_back(reader);                       // WAR
+        access.readers.clear();
+        access.lastWriter = id;
+    }
+
+    std::sort(preds.begin(), preds.end());
+    preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+    for (int p : preds)
+        tasks[p].successors.push_back(id);
+    task.numDeps = preds.size();
+}
+
+namespace {
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<int> ready;
+
+        void push(int id) {
+            std::lock_guard<std::mutex> guard(lock);
+            ready.push_back(id);
+        }
+
+        // Owner takes the newest task (keeps tiles it just produced in cache)
+        bool pop(int& id) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (ready.empty()) return false;
+            id = ready.back();
+            ready.pop_back();
+            return true;
+        }
+
+        // Thieves take the oldest one
+        bool steal(int& id) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (ready.empty()) return false;
+            id = ready.front();
+            ready.pop_front();
+            return true;
+        }
+    };
+}
+
+void TaskGraph::run(int numThreads) {
+    int total = tasks.size();
+    if (total == 0) return;
+    numThreads = std::max(1, numThreads);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    for (int t = 0; t < numThreads; ++t)
+        queues.emplace_back(new WorkerQueue());
+
+    int next = 0;
+    for (int id = 0; id < total; ++id) {
+        tasks[id].remaining.store(tasks[id].numDeps);
+        if (tasks[id].numDeps == 0)
+            queues[next++ % numThreads]->push(id);
+    }
+
+    // The first kernel exception stops every worker; it is rethrown after the join
+    std::atomic<int> done(0);
+    std::atomic<bool> stop(false);
+    std::exception_ptr error;
+    std::mutex errorLock;
+    auto worker = [&](int self) {
+        std::vector<int> released;
+        while (!stop.load(std::memory_order_acquire) && done.load(std::memory_order_acquire) < total) {
+            int id = -1;
+            bool found = queues[self]->pop(id);
+            for (int v = 1; !found && v < numThreads; ++v)
+                found = queues[(self + v) % numThreads]->steal(id);
+            if (!found) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            Task& task = tasks[id];
+            try {
+                task.kernel();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!error) error = std::current_exception();
+                stop.store(true, std::memory_order_release);
+                return;
+            }
+
+            // Critical-path tasks (panels) are pushed last, so they are popped first
+            released.clear();
+            for (int s : task.successors)
+                if (tasks[s].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                    released.push_back(s);
+            std::stable_partition(released.begin(), released.end(),
+                [&](int s) { return !tasks[s].critical; });
+            for (int s : released)
+                queues[self]->push(s);
+
+            done.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // Workers exit once everything is done, so a worker started late (or run
+    // serially by a busy pool) simply finds nothing left
+    ThreadPool::shared().run(numThreads, worker);
+
+    tasks.clear();
+    accesses.clear();
+    if (error) std::rethrow_exception(error);
+}
+
+// ==================== ThreadPool ====================
+
+ThreadPool::ThreadPool(int numWorkers) {
+    for (int t = 0; t < numWorkers; ++t)
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+    }
+    wake.notify_all();
+    for (auto& thread : workers)
+        thread.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(defaultThreadCount() - 1);
+    return pool;
+}
+
+// Runs the remaining indices of the current job, the lock is released around each call
+void ThreadPool::drain(std::unique_lock<std::mutex>& guard) {
+    while (next < count) {
+        int t = next++;
+        const std::function<void(int)>& current = *job;
+        guard.unlock();
+        current(t);
+        guard.lock();
+        if (--pending == 0) finished.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [&] { return quit || next < count; });
+        if (quit) return;
+        drain(guard);
+    }
+}
+
+void ThreadPool::run(int count, const std::function<void(int)>& job) {
+    bool idle = false;
+    if (workers.empty() || count <= 1 || !busy.compare_exchange_strong(idle, true)) {
+        for (int t = 0; t < count; ++t)
+            job(t);
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard(lock);
+    this->job = &job;
+    this->count = count;
+    next = 0;
+    pending = count;
+    wake.notify_all();
+    drain(guard);
+    finished.wait(guard, [&] { return pending == 0; });
+    this->job = nullptr;
+    this->count = next = 0;
+    guard.unlock();
+    busy.store(false);
+}
+
+int defaultThreadCount() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : (int)count;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <exception>
+
+// Persistent workers shared by parallelFor and TaskGraph, so repeated calls
+// (one matvec per GMRES iteration) do not pay for spawning threads.
+// run(count, job) calls job(t) for every t in [0, count); indices are handed
+// out dynamically and the calling thread takes part. Only one job runs at a
+// time: a nested or concurrent call runs its job serially on the caller.
+class ThreadPool {
+public:
+    explicit ThreadPool(int numWorkers);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // job must not throw, callers catch inside it
+    void run(int count, const std::function<void(int)>& job);
+
+    // Process-wide pool with defaultThreadCount() - 1 workers, created on first use
+    static ThreadPool& shared();
+
+private:
+    void workerLoop();
+    void drain(std::unique_lock<std::mutex>& guard);
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake, finished;
+    std::atomic<bool> busy{ false };  // set by the caller for the duration of run()
+    const std::function<void(int)>* job = nullptr;
+    int count = 0, next = 0, pending = 0;
+    bool quit = false;
+};
+
+// Dynamic task-DAG runtime for the tiled factorizations.
+// Every task declares the data it reads and writes (any address works as a handle,
+// the tiled solvers use tile pointers). Dependencies (RAW, WAR, WAW) are derived
+// from the submission order, so a sequential loop nest submits a correct DAG.
+// Ready tasks are executed by a pool of workers: each worker pops the newest task
+// from its own deque and steals the oldest one from the others when it runs dry.
+class TaskGraph {
+public:
+    void addTask(std::function<void()> kernel,
+        const std::vector<const void*>& reads,
+        const std::vector<const void*>& writes,
+        bool critical = false);
+
+    // Executes every submitted task and clears the graph. If a kernel throws, the
+    // remaining tasks are abandoned and the first exception is rethrown here.
+    void run(int numThreads);
+
+    size_t size() const { return tasks.size(); }
+
+private:
+    struct Task {
+        std::function<void()> kernel;
+        std::vector<int> successors;
+        int numDeps = 0;
+        std::atomic<int> remaining{ 0 };
+        bool critical = false;
+    };
+
+    struct Access {
+        int lastWriter = -1;
+        std::vector<int> readers;  // readers since the last write
+    };
+
+    std::deque<Task> tasks;
+    std::unordered_map<const void*, Access> accesses;
+};
+
+int defaultThreadCount();
+
+// Static fork-join over [begin, end): body(lo, hi) is called once per chunk on
+// numThreads contiguous chunks, executed by the shared ThreadPool. An exception
+// thrown by any chunk is rethrown on the calling thread after the join.
+template <typename F>
+void parallelFor(int begin, int end, int numThreads, F&& body) {
+    int count = end - begin;
+    numThreads = std::max(1, std::min(numThreads, count));
+    if (numThreads == 1) {
+        if (count > 0) body(begin, end);
+        return;
+    }
+
+    std::vector<std::exception_ptr> errors(numThreads);
+    int chunk = (count + numThreads - 1) / numThreads;
+    ThreadPool::shared().run(numThreads, [&](int t) {
+        int lo = begin + t * chunk, hi = std::min(end, lo + chunk);
+        if (lo >= hi) return;
+        try { body(lo, hi); }
+        catch (...) { errors[t] = std::current_exception(); }
+    });
+    for (auto& error : errors)
+        if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,421 @@
+#include "LinearAlgebra.h"
+#include "TaskScheduler.h"
+#include "Profiler.h"
+#include <cmath>
+#include <algorithm>
+
+// ==================== Tile storage ====================
+
+TileMatrix toTiles(const Matrix& A, int nb) {
+    TileMatrix T;
+    T.n = A.size();
+    T.nb = nb;
+    T.nt = (T.n + nb - 1) / nb;
+    T.tiles.assign(T.nt * T.nt, Vector(nb * nb, 0.0));
+
+    // Padding is an identity block, so the padded matrix is diag(A, I)
+    int padded = T.nt * nb;
+    for (int r = 0; r < padded; ++r)
+        for (int c = 0; c < padded; ++c)
+            T.at(r, c) = (r < T.n && c < T.n) ? A[r][c] : (r == c ? 1.0 : 0.0);
+    return T;
+}
+
+// ==================== Tile kernels ====================
+// All tiles are nb x nb, row-major.
+
+// C -= A * B
+static void gemmTile(const double* A, const double* B, double* C, int nb) {
+    PROFILE_SCOPE("tiled.gemm");
+    for (int r = 0; r < nb; ++r)
+        for (int k = 0; k < nb; ++k) {
+            double a = A[r * nb + k];
+            if (a == 0.0) continue;
+            for (int c = 0; c < nb; ++c)
+                C[r * nb + c] -= a * B[k * nb + c];
+        }
+}
+
+// C -= A * B^T
+static void gemmTileNT(const double* A, const double* B, double* C, int nb, bool lowerOnly) {
+    for (int r = 0; r < nb; ++r)
+        for (int c = 0; c < (lowerOnly ? r + 1 : nb); ++c) {
+            double sum = 0.0;
+            for (int k = 0; k < nb; ++k)
+                sum += A[r * nb + k] * B[c * nb + k];
+            C[r * nb + c] -= sum;
+        }
+}
+
+// B = L^{-1} * B, L unit lower triangular
+static void trsmUnitLower(const double* L, double* B, int nb) {
+    for (int r = 1; r < nb; ++r)
+        for (int k = 0; k < r; ++k) {
+            double l = L[r * nb + k];
+            for (int c = 0; c < nb; ++c)
+                B[r * nb + c] -= l * B[k * nb + c];
+        }
+}
+
+// B = B * L^{-T}, L lower triangular (Cholesky factor)
+static void trsmLowerTrans(const double* L, double* B, int nb) {
+    for (int r = 0; r < nb; ++r)
+        for (int c = 0; c < nb; ++c) {
+            double sum = B[r * nb + c];
+            for (int k = 0; k < c; ++k)
+                sum -= B[r * nb + k] * L[c * nb + k];
+            B[r * nb + c] = sum / L[c * nb + c];
+        }
+}
+
+static void potrfTile(double* A, int nb) {
+    for (int c = 0; c < nb; ++c) {
+        double d = A[c * nb + c];
+        for (int k = 0; k < c; ++k)
+            d -= A[c * nb + k] * A[c * nb + k];
+        if (d <= 0.0)
+            throw std::runtime_error("tiledCholesky: matrix is not positive definite");
+        d = sqrt(d);
+        A[c * nb + c] = d;
+        for (int r = c + 1; r < nb; ++r) {
+            double sum = A[r * nb + c];
+            for (int k = 0; k < c; ++k)
+                sum -= A[r * nb + k] * A[c * nb + k];
+            A[r * nb + c] = sum / d;
+        }
+        for (int k = c + 1; k < nb; ++k)
+            A[c * nb + k] = 0.0;
+    }
+}
+
+// GETRF of the tall panel (tile column k, rows k*nb..end) with partial pivoting.
+// pivot[r] is the row swapped with r (LAPACK ipiv convention, global rows).
+static void getrfPanel(TileMatrix& A, int k, std::vector<int>& pivot) {
+    PROFILE_SCOPE("tiled.getrf");
+    int nb = A.nb, rows = A.nt * nb;
+    auto row = [&](int r) { return A.tile(r / nb, k) + (r % nb) * nb; };
+
+    for (int c = 0; c < nb; ++c) {
+        int r0 = k * nb + c;
+        int max_row = r0;
+        for (int r = r0 + 1; r < rows; ++r)
+            if (std::abs(row(r)[c]) > std::abs(row(max_row)[c])) max_row = r;
+        pivot[r0] = max_row;
+        if (max_row != r0)
+            std::swap_ranges(row(r0), row(r0) + nb, row(max_row));
+
+        double* prow = row(r0);
+        for (int r = r0 + 1; r < rows; ++r) {
+            double* cur = row(r);
+            cur[c] /= prow[c];
+            for (int j = c + 1; j < nb; ++j)
+                cur[j] -= cur[c] * prow[j];
+        }
+    }
+}
+
+// LASWP of panel k applied to tile column j, then U_kj = L_kk^{-1} * A_kj
+static void swapTrsm(TileMatrix& A, int k, int j, const std::vector<int>& pivot) {
+    PROFILE_SCOPE("tiled.trsm");
+    int nb = A.nb;
+    auto row = [&](int r) { return A.tile(r / nb, j) + (r % nb) * nb; };
+    for (int c = 0; c < nb; ++c) {
+        int r0 = k * nb + c;
+        if (pivot[r0] != r0)
+            std::swap_ranges(row(r0), row(r0) + nb, row(pivot[r0]));
+    }
+    trsmUnitLower(A.tile(k, k), A.tile(k, j), nb);
+}
+
+// Householder QR of one tile, reflectors below the diagonal
+static void geqrtTile(double* A, double* tau, int nb) {
+    for (int c = 0; c < nb; ++c) {
+        double alpha = A[c * nb + c];
+        double sigma = 0.0;
+        for (int r = c + 1; r < nb; ++r)
+            sigma += A[r * nb + c] * A[r * nb + c];
+        tau[c] = 0.0;
+        if (sigma == 0.0) continue;
+
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        double scale = 1.0 / (alpha - beta);
+        for (int r = c + 1; r < nb; ++r)
+            A[r * nb + c] *= scale;
+        A[c * nb + c] = beta;
+        tau[c] = (beta - alpha) / beta;
+
+        for (int j = c + 1; j < nb; ++j) {
+            double dot = A[c * nb + j];
+            for (int r = c + 1; r < nb; ++r)
+                dot += A[r * nb + c] * A[r * nb + j];
+            dot *= tau[c];
+            A[c * nb + j] -= dot;
+            for (int r = c + 1; r < nb; ++r)
+                A[r * nb + j] -= dot * A[r * nb + c];
+        }
+    }
+}
+
+// B = Q^T * B with Q from geqrtTile
+static void unmqrTile(const double* V, const double* tau, double* B, int nb) {
+    for (int c = 0; c < nb; ++c) {
+        if (tau[c] == 0.0) continue;
+        for (int j = 0; j < nb; ++j) {
+            double dot = B[c * nb + j];
+            for (int r = c + 1; r < nb; ++r)
+                dot += V[r * nb + c] * B[r * nb + j];
+            dot *= tau[c];
+            B[c * nb + j] -= dot;
+            for (int r = c + 1; r < nb; ++r)
+                B[r * nb + j] -= dot * V[r * nb + c];
+        }
+    }
+}
+
+// QR of [R; A] with R upper triangular: R is updated, A is replaced by the reflectors
+static void tsqrtTile(double* R, double* A, double* tau, int nb) {
+    for (int c = 0; c < nb; ++c) {
+        double alpha = R[c * nb + c];
+        double sigma = 0.0;
+        for (int r = 0; r < nb; ++r)
+            sigma += A[r * nb + c] * A[r * nb + c];
+        tau[c] = 0.0;
+        if (sigma == 0.0) continue;
+
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        double scale = 1.0 / (alpha - beta);
+        for (int r = 0; r < nb; ++r)
+            A[r * nb + c] *= scale;
+        R[c * nb + c] = beta;
+        tau[c] = (beta - alpha) / beta;
+
+        for (int j = c + 1; j < nb; ++j) {
+            double dot = R[c * nb + j];
+            for (int r = 0; r < nb; ++r)
+                dot += A[r * nb + c] * A[r * nb + j];
+            dot *= tau[c];
+            R[c * nb + j] -= dot;
+            for (int r = 0; r < nb; ++r)
+                A[r * nb + j] -= dot * A[r * nb + c];
+        }
+    }
+}
+
+// [B1; B2] = Q^T * [B1; B2] with Q from tsqrtTile
+static void tsmqrTile(const double* V, const double* tau, double* B1, double* B2, int nb) {
+    for (int c = 0; c < nb; ++c) {
+        if (tau[c] == 0.0) continue;
+        for (int j = 0; j < nb; ++j) {
+            double dot = B1[c * nb + j];
+            for (int r = 0; r < nb; ++r)
+                dot += V[r * nb + c] * B2[r * nb + j];
+            dot *= tau[c];
+            B1[c * nb + j] -= dot;
+            for (int r = 0; r < nb; ++r)
+                B2[r * nb + j] -= dot * V[r * nb + c];
+        }
+    }
+}
+
+// ==================== Tiled factorizations ====================
+// Each factorization is submitted as a plain loop nest over tiles; the runtime
+// turns it into a DAG, so the next panel starts as soon as its own tile column
+// is updated instead of waiting for the whole trailing matrix (lookahead).
+
+void tiledLU(TileMatrix& A, std::vector<int>& pivot, int numThreads) {
+    int nt = A.nt, nb = A.nb;
+    pivot.assign(nt * nb, 0);
+
+    TaskGraph graph;
+    for (int k = 0; k < nt; ++k) {
+        // Pivot search runs over the whole tile column
+        std::vector<const void*> panel;
+        for (int i = k; i < nt; ++i) panel.push_back(A.tile(i, k));
+        graph.addTask([&A, &pivot, k] { getrfPanel(A, k, pivot); }, {}, panel, true);
+
+        for (int j = k + 1; j < nt; ++j) {
+            std::vector<const void*> column;
+            for (int i = k; i < nt; ++i) column.push_back(A.tile(i, j));
+            graph.addTask([&A, &pivot, k, j] { swapTrsm(A, k, j, pivot); },
+                { A.tile(k, k) }, column, j == k + 1);
+
+            for (int i = k + 1; i < nt; ++i) {
+                const double* Lik = A.tile(i, k);
+                const double* Ukj = A.tile(k, j);
+                double* Aij = A.tile(i, j);
+                graph.addTask([=] { gemmTile(Lik, Ukj, Aij, nb); },
+                    { Lik, Ukj }, { Aij }, j == k + 1);
+            }
+        }
+    }
+    graph.run(numThreads);
+}
+
+void tiledCholesky(TileMatrix& A, int numThreads) {
+    int nt = A.nt, nb = A.nb;
+
+    TaskGraph graph;
+    for (int k = 0; k < nt; ++k) {
+        double* Akk = A.tile(k, k);
+        graph.addTask([=] { potrfTile(Akk, nb); }, {}, { Akk }, true);
+
+        for (int i = k + 1; i < nt; ++i) {
+            double* Aik = A.tile(i, k);
+            graph.addTask([=] { trsmLowerTrans(Akk, Aik, nb); }, { Akk }, { Aik }, i == k + 1);
+        }
+
+        for (int i = k + 1; i < nt; ++i) {
+            const double* Aik = A.tile(i, k);
+            double* Aii = A.tile(i, i);
+            graph.addTask([=] { gemmTileNT(Aik, Aik, Aii, nb, true); },      // SYRK
+                { Aik }, { Aii }, i == k + 1);
+
+            for (int j = k + 1; j < i; ++j) {
+                const double* Ajk = A.tile(j, k);
+                double* Aij = A.tile(i, j);
+                graph.addTask([=] { gemmTileNT(Aik, Ajk, Aij, nb, false); },
+                    { Aik, Ajk }, { Aij });
+            }
+        }
+    }
+    graph.run(numThreads);
+
+    // Upper tiles are not part of the factor
+    for (int i = 0; i < nt; ++i)
+        for (int j = i + 1; j < nt; ++j)
+            std::fill(A.tiles[i * nt + j].begin(), A.tiles[i * nt + j].end(), 0.0);
+}
+
+void tiledQR(TileMatrix& A, std::vector<Vector>& tau, int numThreads) {
+    int nt = A.nt, nb = A.nb;
+    tau.assign(nt * nt, Vector(nb, 0.0));
+
+    // UNMQR/TSMQR only need the reflectors, which no later task overwrites, so they
+    // depend on the tau handle and not on the tile: TSQRT keeps updating the R part
+    // of the diagonal tile while the updates of row k are still running.
+    TaskGraph graph;
+    for (int k = 0; k < nt; ++k) {
+        double* Akk = A.tile(k, k);
+        double* tkk = tau[k * nt + k].data();
+        graph.addTask([=] { geqrtTile(Akk, tkk, nb); }, {}, { Akk, tkk }, true);
+
+        for (int j = k + 1; j < nt; ++j) {
+            double* Akj = A.tile(k, j);
+            graph.addTask([=] { unmqrTile(Akk, tkk, Akj, nb); }, { tkk }, { Akj }, j == k + 1);
+        }
+
+        for (int i = k + 1; i < nt; ++i) {
+            double* Aik = A.tile(i, k);
+            double* tik = tau[i * nt + k].data();
+            graph.addTask([=] { tsqrtTile(Akk, Aik, tik, nb); }, {}, { Akk, Aik, tik }, true);
+
+            for (int j = k + 1; j < nt; ++j) {
+                double* Akj = A.tile(k, j);
+                double* Aij = A.tile(i, j);
+                graph.addTask([=] { tsmqrTile(Aik, tik, Akj, Aij, nb); },
+                    { tik }, { Akj, Aij }, j == k + 1);
+            }
+        }
+    }
+    graph.run(numThreads);
+}
+
+// ==================== Tiled solves ====================
+
+static Vector padRightHandSide(const TileMatrix& A, const Vector& f) {
+    Vector b(A.nt * A.nb, 0.0);
+    std::copy(f.begin(), f.end(), b.begin());
+    return b;
+}
+
+static Vector backSubstitution(const TileMatrix& U, Vector y) {
+    int N = U.nt * U.nb;
+    for (int i = N - 1; i >= 0; --i) {
+        for (int j = i + 1; j < N; ++j)
+            y[i] -= U.at(i, j) * y[j];
+        y[i] /= U.at(i, i);
+    }
+    y.resize(U.n);
+    return y;
+}
+
+Vector solveTiledLU(const TileMatrix& LU, const std::vector<int>& pivot, const Vector& f) {
+    int nb = LU.nb, N = LU.nt * nb;
+    Vector y = padRightHandSide(LU, f);
+
+    // L was not swapped back, so the swaps of every panel are applied before its columns
+    for (int k = 0; k < LU.nt; ++k) {
+        for (int c = 0; c < nb; ++c)
+            std::swap(y[k * nb + c], y[pivot[k * nb + c]]);
+        for (int c = k * nb; c < (k + 1) * nb; ++c)
+            for (int i = c + 1; i < N; ++i)
+                y[i] -= LU.at(i, c) * y[c];
+    }
+    return backSubstitution(LU, y);
+}
+
+Vector solveTiledCholesky(const TileMatrix& L, const Vector& f) {
+    int N = L.nt * L.nb;
+    Vector y = padRightHandSide(L, f);
+
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < i; ++j)
+            y[i] -= L.at(i, j) * y[j];
+        y[i] /= L.at(i, i);
+    }
+    for (int i = N - 1; i >= 0; --i) {
+        for (int j = i + 1; j < N; ++j)
+            y[i] -= L.at(j, i) * y[j];
+        y[i] /= L.at(i, i);
+    }
+    y.resize(L.n);
+    return y;
+}
+
+Vector solveTiledQR(const TileMatrix& QR, const std::vector<Vector>& tau, const Vector& f) {
+    int nt = QR.nt, nb = QR.nb;
+    Vector y = padRightHandSide(QR, f);
+
+    // Q^T * f: replay GEQRT(k) and TSQRT(k, i) in factorization order
+    for (int k = 0; k < nt; ++k) {
+        const double* V = QR.tile(k, k);
+        const Vector& tkk = tau[k * nt + k];
+        double* yk = &y[k * nb];
+        for (int c = 0; c < nb; ++c) {
+            if (tkk[c] == 0.0) continue;
+            double dot = yk[c];
+            for (int r = c + 1; r < nb; ++r)
+                dot += V[r * nb + c] * yk[r];
+            dot *= tkk[c];
+            yk[c] -= dot;
+            for (int r = c + 1; r < nb; ++r)
+                yk[r] -= dot * V[r * nb + c];
+        }
+
+        for (int i = k + 1; i < nt; ++i) {
+            const double* W = QR.tile(i, k);
+            const Vector& tik = tau[i * nt + k];
+            double* yi = &y[i * nb];
+            for (int c = 0; c < nb; ++c) {
+                if (tik[c] == 0.0) continue;
+                double dot = yk[c];
+                for (int r = 0; r < nb; ++r)
+                    dot += W[r * nb + c] * yi[r];
+                dot *= tik[c];
+                yk[c] -= dot;
+                for (int r = 0; r < nb; ++r)
+                    yi[r] -= dot * W[r * nb + c];
+            }
+        }
+    }
+
+    // R: upper part of the diagonal tiles and the full tiles to their right
+    int N = nt * nb;
+    for (int i = N - 1; i >= 0; --i) {
+        for (int j = i + 1; j < N; ++j)
+            y[i] -= QR.at(i, j) * y[j];
+        y[i] /= QR.at(i, i);
+    }
+    y.resize(QR.n);
+    return y;
+}
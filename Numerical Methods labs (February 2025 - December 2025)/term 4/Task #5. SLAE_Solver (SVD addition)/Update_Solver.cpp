@@ -0,0 +1,205 @@
+#include "LinearAlgebra.h"
+#include <cmath>
+#include <algorithm>
+
+// Updates of existing factorizations (Golub & Van Loan, 12.5).
+// Q is the full m x m orthogonal factor and R is m x n, as returned by householderQR.
+// Every routine costs O(m^2 + mn) instead of the O(n^3) refactorization.
+
+// Rotation [c s; -s c] that maps (a, b) to (r, 0)
+static void givens(double a, double b, double& c, double& s) {
+    if (b == 0.0) {
+        c = 1.0;
+        s = 0.0;
+        return;
+    }
+    double r = std::hypot(a, b);
+    c = a / r;
+    s = b / r;
+}
+
+// Rows i and k of R (from column `from`) are rotated, columns i and k of Q follow
+static void rotate(Matrix& Q, Matrix& R, int i, int k, double c, double s, int from) {
+    int n = R[0].size();
+    for (int j = from; j < n; ++j) {
+        double ri = R[i][j], rk = R[k][j];
+        R[i][j] = c * ri + s * rk;
+        R[k][j] = -s * ri + c * rk;
+    }
+    for (int r = 0; r < (int)Q.size(); ++r) {
+        double qi = Q[r][i], qk = Q[r][k];
+        Q[r][i] = c * qi + s * qk;
+        Q[r][k] = -s * qi + c * qk;
+    }
+}
+
+// Brings an upper Hessenberg R (from column `from`) back to triangular form
+static void retriangulate(Matrix& Q, Matrix& R, int from) {
+    int m = R.size(), n = R[0].size();
+    for (int k = from; k < std::min(m - 1, n); ++k) {
+        double c, s;
+        givens(R[k][k], R[k + 1][k], c, s);
+        rotate(Q, R, k, k + 1, c, s, k);
+        R[k + 1][k] = 0.0;
+    }
+}
+
+// Q * R <- Q * R + u * v^T
+void qrRank1Update(Matrix& Q, Matrix& R, const Vector& u, const Vector& v) {
+    int m = R.size(), n = R[0].size();
+
+    // w = Q^T * u
+    Vector w = multiply(Q, u, true);
+
+    // Reduce w to |w| * e1, R becomes upper Hessenberg
+    for (int k = m - 1; k > 0; --k) {
+        double c, s;
+        givens(w[k - 1], w[k], c, s);
+        w[k - 1] = c * w[k - 1] + s * w[k];
+        w[k] = 0.0;
+        rotate(Q, R, k - 1, k, c, s, std::max(0, k - 1));
+    }
+
+    for (int j = 0; j < n; ++j)
+        R[0][j] += w[0] * v[j];
+
+    retriangulate(Q, R, 0);
+}
+
+// Q * R <- Q * R + U * V^T, U is m x k and V is n x k
+void qrRankUpdate(Matrix& Q, Matrix& R, const Matrix& U, const Matrix& V) {
+    int k = U.empty() ? 0 : U[0].size();
+    Vector u(U.size()), v(V.size());
+    for (int c = 0; c < k; ++c) {
+        for (size_t i = 0; i < U.size(); ++i) u[i] = U[i][c];
+        for (size_t i = 0; i < V.size(); ++i) v[i] = V[i][c];
+        qrRank1Update(Q, R, u, v);
+    }
+}
+
+// Removes column j of A
+void qrDeleteColumn(Matrix& Q, Matrix& R, int j) {
+    for (auto& row : R)
+        row.erase(row.begin() + j);
+    retriangulate(Q, R, j);
+}
+
+// Inserts a as column j of A
+void qrInsertColumn(Matrix& Q, Matrix& R, int j, const Vector& a) {
+    int m = R.size();
+
+    Vector w = multiply(Q, a, true);
+    for (int i = 0; i < m; ++i)
+        R[i].insert(R[i].begin() + j, w[i]);
+
+    // Zero the new column below the diagonal, bottom-up; R stays triangular
+    for (int k = m - 1; k > j; --k) {
+        double c, s;
+        givens(R[k - 1][j], R[k][j], c, s);
+        rotate(Q, R, k - 1, k, c, s, j);
+        R[k][j] = 0.0;
+    }
+}
+
+// Removes row i of A
+void qrDeleteRow(Matrix& Q, Matrix& R, int i) {
+    int m = R.size();
+
+    // Rotate row i of Q into +-e1, R picks up a subdiagonal
+    Vector q = Q[i];
+    for (int k = m - 1; k > 0; --k) {
+        double c, s;
+        givens(q[k - 1], q[k], c, s);
+        q[k - 1] = c * q[k - 1] + s * q[k];
+        q[k] = 0.0;
+        rotate(Q, R, k - 1, k, c, s, std::max(0, k - 1));
+    }
+
+    // Now Q = [+-1 0; 0 Q1] up to the row order and R = [r^T; R1]
+    Q.erase(Q.begin() + i);
+    for (auto& row : Q)
+        row.erase(row.begin());
+    R.erase(R.begin());
+}
+
+// Inserts a as row i of A
+void qrInsertRow(Matrix& Q, Matrix& R, int i, const Vector& a) {
+    int m = R.size();
+
+    // [a^T; R] is upper Hessenberg, Q grows to diag(1, Q) with row 0 moved to i
+    R.insert(R.begin(), a);
+    Matrix Qext(m + 1, Vector(m + 1, 0.0));
+    for (int r = 0; r <= m; ++r) {
+        if (r == i) {
+            Qext[r][0] = 1.0;
+            continue;
+        }
+        const Vector& src = Q[r < i ? r : r - 1];
+        std::copy(src.begin(), src.end(), Qext[r].begin() + 1);
+    }
+    Q = std::move(Qext);
+
+    retriangulate(Q, R, 0);
+}
+
+// ==================== Sherman-Morrison-Woodbury on top of a cached LU ====================
+// (A + U * V^T)^{-1} f = y - Z * C^{-1} * V^T * y,  y = A^{-1} f,  Z = A^{-1} U,  C = I + V^T Z
+
+void woodburyPrepare(const Matrix& LU, const std::vector<int>& pivot,
+    const Matrix& U, const Matrix& V,
+    Matrix& Z, Matrix& capacitance, std::vector<int>& capPivot) {
+    int n = LU.size();
+    int k = U[0].size();
+
+    Z = Matrix(n, Vector(k));
+    Vector col(n);
+    for (int c = 0; c < k; ++c) {
+        for (int i = 0; i < n; ++i) col[i] = U[i][c];
+        Vector z = solveLU(LU, pivot, col);
+        for (int i = 0; i < n; ++i) Z[i][c] = z[i];
+    }
+
+    capacitance = multiply(V, Z, true, false);
+    for (int c = 0; c < k; ++c)
+        capacitance[c][c] += 1.0;
+    luDecomposition(capacitance, capPivot);
+}
+
+Vector solveWoodbury(const Matrix& LU, const std::vector<int>& pivot, const Matrix& V,
+    const Matrix& Z, const Matrix& capacitance, const std::vector<int>& capPivot,
+    const Vector& f) {
+    int n = LU.size();
+    int k = Z[0].size();
+
+    Vector y = solveLU(LU, pivot, f);
+
+    Vector t = multiply(V, y, true);
+    Vector s = solveLU(capacitance, capPivot, t);
+
+    for (int i = 0; i < n; ++i)
+        for (int c = 0; c < k; ++c)
+            y[i] -= Z[i][c] * s[c];
+    return y;
+}
+
+// Rank-1 case: (A + u * v^T) x = f
+Vector solveShermanMorrison(const Matrix& LU, const std::vector<int>& pivot,
+    const Vector& u, const Vector& v, const Vector& f) {
+    int n = LU.size();
+    Vector y = solveLU(LU, pivot, f);
+    Vector z = solveLU(LU, pivot, u);
+
+    double vy = 0.0, vz = 0.0;
+    for (int i = 0; i < n; ++i) {
+        vy += v[i] * y[i];
+        vz += v[i] * z[i];
+    }
+    double denom = 1.0 + vz;
+    if (std::abs(denom) < 1e-14)
+        throw std::runtime_error("solveShermanMorrison: updated matrix is singular");
+
+    double scale = vy / denom;
+    for (int i = 0; i < n; ++i)
+        y[i] -= scale * z[i];
+    return y;
+}
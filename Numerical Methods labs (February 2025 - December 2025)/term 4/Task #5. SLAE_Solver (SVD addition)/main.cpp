@@ -1,9 +1,13 @@
 ﻿#include "LinearAlgebra.h"
+#include "LinearOperator.h"
+#include "Profiler.h"
+#include "TaskScheduler.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
 #include <algorithm>
 #include <vector>
+#include <exception>
 
 // Median calculation
 long long calculateMedianTime(std::vector<long long>& timings) {
@@ -19,10 +23,22 @@ long long calculateMedianTime(std::vector<long long>& timings) {
     }
 }
 
+// Frobenius norm of X - Y
+double frobeniusDiff(const Matrix& X, const Matrix& Y) {
+    double sum = 0.0;
+    for (size_t i = 0; i < X.size(); ++i)
+        for (size_t j = 0; j < X[i].size(); ++j)
+            sum += (X[i][j] - Y[i][j]) * (X[i][j] - Y[i][j]);
+    return std::sqrt(sum);
+}
+
 int main() {
     std::vector<int> sizes = { 5, 10, 20 };
     const int num_measurements = 5;
+    const int tile_size = 4;
+    const int tile_threads = std::max(2, defaultThreadCount());
     std::cout << std::fixed << std::setprecision(6);
+    PROFILE_TRACE_EVENTS(true);
     std::cout << "Size | Method |   Median Time   |   Error   | Condition Number" << std::endl;
     std::cout << "----------------------------------------------------------" << std::endl;
 
@@ -55,6 +71,25 @@ int main() {
                 << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
         }
 
+        // LU through the fixed-size kernels (same algorithm, unrolled, on the stack)
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Vector x = solveDirect(A, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | LU<N>  | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
+        }
+
         // QR decomposition
         {
             std::vector<long long> timings;
@@ -76,6 +111,277 @@ int main() {
                 << " | " << std::scientific << std::setprecision(3) << final_error
                 << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
         }
+        // QR through the fixed-size kernels (compact Householder form, unrolled, on the stack)
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Vector x = solveDirectQR(A, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | QR<N>  | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
+        }
+        // QR with column pivoting (rank-revealing, minimum-norm solution)
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+            int rank = 0;
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Matrix QR = A;
+                Vector tau, tauZ;
+                std::vector<int> jpvt;
+                rank = pivotedQR(QR, tau, jpvt);
+                completeOrthogonal(QR, rank, tauZ);
+                Vector x = solveMinNormQR(QR, tau, jpvt, rank, tauZ, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | QRCP   | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond
+                << " (rank " << rank << ")" << std::endl;
+        }
+        // Tiled LU as a task DAG (the matrix is split into tile_size x tile_size tiles)
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                TileMatrix LU = toTiles(A, tile_size);
+                std::vector<int> pivot;
+                tiledLU(LU, pivot, tile_threads);
+                Vector x = solveTiledLU(LU, pivot, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | tLU    | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
+        }
+        // Tiled QR (TSQR-style panels) as a task DAG
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                TileMatrix QR = toTiles(A, tile_size);
+                std::vector<Vector> tau;
+                tiledQR(QR, tau, tile_threads);
+                Vector x = solveTiledQR(QR, tau, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | tQR    | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
+        }
+        // Tiled Cholesky on the SPD matrix A^T A + N * I (A itself is not SPD, and A^T A
+        // alone squares its condition number and is singular in floating point)
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+            Matrix M = syrk(A);
+            for (int i = 0; i < N; ++i)
+                M[i][i] += N;
+            Vector g = createRightHandSide(M);
+            double condM = computeConditionNumber(M);
+
+            try {
+                for (int i = 0; i < num_measurements; ++i) {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    TileMatrix L = toTiles(M, tile_size);
+                    tiledCholesky(L, tile_threads);
+                    Vector x = solveTiledCholesky(L, g);
+                    auto stop = std::chrono::high_resolution_clock::now();
+                    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                    timings.push_back(duration.count());
+                    final_error = computeError(x, x_exact);
+                }
+                long long median_time = calculateMedianTime(timings);
+                std::cout << std::setw(4) << N << " | tChol  | " << std::setw(15) << median_time
+                    << " | " << std::scientific << std::setprecision(3) << final_error
+                    << " | " << std::fixed << std::setprecision(2) << condM << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cout << std::setw(4) << N << " | tChol  | " << e.what() << std::endl;
+            }
+        }
+        // Updates of a cached QR: rank-1 update, column insert/delete, row insert/delete.
+        // Error is ||QR - A'||_F / ||A'||_F for the updated A', orth is ||Q^T Q - I||_F
+        {
+            std::vector<long long> timings;
+            Matrix Q0, R0;
+            householderQR(A, Q0, R0);
+
+            Vector u(N), v(N), column(N), row(N);
+            for (int i = 0; i < N; ++i) {
+                u[i] = 1.0 / (i + 1);
+                v[i] = std::cos(i);
+                column[i] = std::sin(i + 1.0);
+                row[i] = 1.0 / (N - i);
+            }
+
+            // A' built explicitly with the same sequence of edits
+            Matrix updated = A;
+            for (int i = 0; i < N; ++i)
+                for (int j = 0; j < N; ++j)
+                    updated[i][j] += u[i] * v[j];
+            for (int i = 0; i < N; ++i) {
+                updated[i].insert(updated[i].begin() + N / 2, column[i]);
+                updated[i].erase(updated[i].begin());
+            }
+            updated.insert(updated.begin() + N / 2, row);
+            updated.erase(updated.begin());
+
+            Matrix Q, R;
+            for (int i = 0; i < num_measurements; ++i) {
+                Q = Q0;
+                R = R0;
+                auto start = std::chrono::high_resolution_clock::now();
+                qrRank1Update(Q, R, u, v);
+                qrInsertColumn(Q, R, N / 2, column);
+                qrDeleteColumn(Q, R, 0);
+                qrInsertRow(Q, R, N / 2, row);
+                qrDeleteRow(Q, R, 0);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+            }
+
+            Matrix identity(N, Vector(N, 0.0));
+            for (int i = 0; i < N; ++i) identity[i][i] = 1.0;
+            Matrix zero(N, Vector(N, 0.0));
+            double final_error = frobeniusDiff(multiply(Q, R), updated) / frobeniusDiff(updated, zero);
+            double orth = frobeniusDiff(multiply(Q, Q, true, false), identity);
+
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | QRupd  | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | orth " << orth << std::fixed << std::setprecision(6) << std::endl;
+        }
+        // Sherman-Morrison and rank-2 Woodbury solves of the updated system on top of
+        // the cached LU of A. The update lies in the range of A (U = A * W), so
+        // A + U * V^T = A * (I + W * V^T) keeps the conditioning of A and the
+        // capacitance matrix I + V^T * A^-1 * U stays well conditioned. The error is
+        // against x_exact for the rhs of the updated matrix. Woodbury inherits the
+        // conditioning of the cached LU: on the ill-conditioned lab matrix it is as
+        // accurate as the LU row, not more.
+        {
+            Matrix LU0 = A;
+            std::vector<int> pivot0;
+            luDecomposition(LU0, pivot0);
+
+            Matrix W(N, Vector(2)), V(N, Vector(2));
+            for (int i = 0; i < N; ++i) {
+                W[i][0] = 0.5 / (i + 1);
+                V[i][0] = std::cos(i);
+                W[i][1] = (i % 2 == 0) ? 0.5 : -0.5;
+                V[i][1] = 1.0 / (N + i);
+            }
+            Matrix U = multiply(A, W);
+            Vector u(N), v(N);
+            for (int i = 0; i < N; ++i) {
+                u[i] = U[i][0];
+                v[i] = V[i][0];
+            }
+
+            for (int rank = 1; rank <= 2; ++rank) {
+                Matrix updated = A;
+                for (int i = 0; i < N; ++i)
+                    for (int j = 0; j < N; ++j)
+                        for (int c = 0; c < rank; ++c)
+                            updated[i][j] += U[i][c] * V[j][c];
+                Vector g = createRightHandSide(updated);
+                double cond_updated = computeConditionNumber(updated);
+
+                std::vector<long long> timings;
+                Vector x;
+                for (int i = 0; i < num_measurements; ++i) {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    if (rank == 1) {
+                        x = solveShermanMorrison(LU0, pivot0, u, v, g);
+                    }
+                    else {
+                        Matrix Z, capacitance;
+                        std::vector<int> capPivot;
+                        woodburyPrepare(LU0, pivot0, U, V, Z, capacitance, capPivot);
+                        x = solveWoodbury(LU0, pivot0, V, Z, capacitance, capPivot, g);
+                    }
+                    auto stop = std::chrono::high_resolution_clock::now();
+                    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                    timings.push_back(duration.count());
+                }
+                double final_error = computeError(x, x_exact);
+
+                long long median_time = calculateMedianTime(timings);
+                std::cout << std::setw(4) << N << (rank == 1 ? " | SM     | " : " | SMW    | ")
+                    << std::setw(15) << median_time
+                    << " | " << std::scientific << std::setprecision(3) << final_error
+                    << " | " << std::fixed << std::setprecision(2) << cond_updated << std::endl;
+            }
+        }
+        // Low-rank (ACA) solve on the matrix-free kernel operator, A is not materialized
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+            KernelOperator K(N);
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Vector x = solveLowRank(K, f);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | ACA    | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond << std::endl;
+        }
+        // Restarted GMRES on the same matrix-free operator, every iteration is one matvec
+        {
+            std::vector<long long> timings;
+            double final_error = 0.0;
+            int iterations = 0;
+            KernelOperator K(N);
+
+            for (int i = 0; i < num_measurements; ++i) {
+                auto start = std::chrono::high_resolution_clock::now();
+                Vector x = solveGMRES(K, f, 1e-10, 50, 1000, &iterations);
+                auto stop = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+                timings.push_back(duration.count());
+                final_error = computeError(x, x_exact);
+            }
+            long long median_time = calculateMedianTime(timings);
+            std::cout << std::setw(4) << N << " | GMRES  | " << std::setw(15) << median_time
+                << " | " << std::scientific << std::setprecision(3) << final_error
+                << " | " << std::fixed << std::setprecision(2) << cond
+                << " (" << iterations << " it)" << std::endl;
+        }
         // SVD decomposition
         {
             std::vector<long long> timings;
@@ -99,6 +405,10 @@ int main() {
         std::cout << "-------------------------------------------" << std::endl;
     }
 
+    // Phase breakdown, only in builds configured with -DSLAE_PROFILE=ON
+    PROFILE_REPORT(std::cout);
+    PROFILE_WRITE_TRACE("slae_trace.json");
+
     system("pause");
     return 0;
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿#include <iostream>
 #include <vector>
+#include <array>
 #include <complex>
 #include <cmath>
 #include <chrono>
@@ -8,215 +9,3706 @@
 #include <fstream>
 #include <string>
 #include <iomanip>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <tuple>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace std::chrono;
 
-using Complex = complex<double>;
-const double PI = 3.14159265358979323846;
+using Complex = complex<double>;
+using ComplexF = complex<float>;
+const double PI = 3.14159265358979323846;
+
+// ==================== ПУНКТ 1: БАЗОВЫЕ ПРЕОБРАЗОВАНИЯ ====================
+
+vector<Complex> dft(const vector<Complex>& input) {
+    int N = input.size();
+    vector<Complex> output(N, 0);
+
+    for (int m = 0; m < N; m++) {
+        for (int n = 0; n < N; n++) {
+            double angle = -2 * PI * m * n / N;
+            output[m] += input[n] * exp(Complex(0, angle));
+        }
+    }
+    return output;
+}
+
+vector<Complex> idft(const vector<Complex>& input) {
+    int N = input.size();
+    vector<Complex> output(N, 0);
+
+    for (int n = 0; n < N; n++) {
+        for (int m = 0; m < N; m++) {
+            double angle = 2 * PI * m * n / N;
+            output[n] += input[m] * exp(Complex(0, angle));
+        }
+        output[n] /= N;
+    }
+    return output;
+}
+
+// ==================== СТЕПЕНИ ДВОЙКИ ====================
+
+bool isPowerOfTwo(int N) {
+    return N > 0 && (N & (N - 1)) == 0;
+}
+
+int nextPowerOfTwo(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// ==================== SIMD-ЯДРА (РАЗДЕЛЬНОЕ ХРАНЕНИЕ) ====================
+
+// Внутри ядер вещественные и мнимые части лежат в отдельных массивах (SoA):
+// один регистр содержит W соседних вещественных частей, комплексное умножение -
+// это 4 умножения / FMA без перестановок внутри регистра. Этапы по 4 (Stockham),
+// при нечетном log2(N) последний этап по 2. Векторизация идет по q (шаг s),
+// этапы с s < W выполняются той же схемой скалярно.
+// Набор инструкций выбирается при запуске: AVX-512, AVX2+FMA, SSE2 или скалярный код.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FFT_X86_DISPATCH 1
+#define FFT_INLINE inline __attribute__((always_inline))
+#define FFT_TARGET_SSE2 __attribute__((target("sse2")))
+#define FFT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define FFT_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define FFT_INLINE inline
+#endif
+
+enum class SimdLevel { Scalar, SSE2, AVX2, AVX512 };
+
+SimdLevel detectSimdLevel() {
+#ifdef FFT_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel activeSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX512: return "AVX-512";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::SSE2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+// Векторные операции над W числами double (…D) или float (…F).
+// В регистре float вдвое больше чисел, ядра те же.
+struct ScalarD {
+    using Real = double;
+    using T = double;
+    static const int W = 1;
+    static FFT_INLINE T load(const double* p) { return *p; }
+    static FFT_INLINE void store(double* p, T a) { *p = a; }
+    static FFT_INLINE T set1(double a) { return a; }
+    static FFT_INLINE T add(T a, T b) { return a + b; }
+    static FFT_INLINE T sub(T a, T b) { return a - b; }
+    static FFT_INLINE T mul(T a, T b) { return a * b; }
+    static FFT_INLINE T fmadd(T a, T b, T c) { return a * b + c; }    // a*b + c
+    static FFT_INLINE T fnmadd(T a, T b, T c) { return c - a * b; }   // c - a*b
+};
+
+struct ScalarF {
+    using Real = float;
+    using T = float;
+    static const int W = 1;
+    static FFT_INLINE T load(const float* p) { return *p; }
+    static FFT_INLINE void store(float* p, T a) { *p = a; }
+    static FFT_INLINE T set1(float a) { return a; }
+    static FFT_INLINE T add(T a, T b) { return a + b; }
+    static FFT_INLINE T sub(T a, T b) { return a - b; }
+    static FFT_INLINE T mul(T a, T b) { return a * b; }
+    static FFT_INLINE T fmadd(T a, T b, T c) { return a * b + c; }
+    static FFT_INLINE T fnmadd(T a, T b, T c) { return c - a * b; }
+};
+
+// Скалярные операции той же точности: ими считаются этапы с шагом меньше W
+template <typename Real>
+using ScalarOps = typename conditional<is_same<Real, float>::value, ScalarF, ScalarD>::type;
+
+#ifdef FFT_X86_DISPATCH
+// Ядра встраиваются в функции с нужным target, предупреждение об ABI к ним не относится
+// (сами операции - обычные inline: always_inline нельзя встроить в функцию без target).
+// Отключено только до точек входа splitFFT*, ниже -Wpsabi снова действует.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+struct SSE2D {
+    using Real = double;
+    using T = __m128d;
+    static const int W = 2;
+    FFT_TARGET_SSE2 static inline T load(const double* p) { return _mm_loadu_pd(p); }
+    FFT_TARGET_SSE2 static inline void store(double* p, T a) { _mm_storeu_pd(p, a); }
+    FFT_TARGET_SSE2 static inline T set1(double a) { return _mm_set1_pd(a); }
+    FFT_TARGET_SSE2 static inline T add(T a, T b) { return _mm_add_pd(a, b); }
+    FFT_TARGET_SSE2 static inline T sub(T a, T b) { return _mm_sub_pd(a, b); }
+    FFT_TARGET_SSE2 static inline T mul(T a, T b) { return _mm_mul_pd(a, b); }
+    FFT_TARGET_SSE2 static inline T fmadd(T a, T b, T c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+    FFT_TARGET_SSE2 static inline T fnmadd(T a, T b, T c) { return _mm_sub_pd(c, _mm_mul_pd(a, b)); }
+};
+
+struct AVX2D {
+    using Real = double;
+    using T = __m256d;
+    static const int W = 4;
+    FFT_TARGET_AVX2 static inline T load(const double* p) { return _mm256_loadu_pd(p); }
+    FFT_TARGET_AVX2 static inline void store(double* p, T a) { _mm256_storeu_pd(p, a); }
+    FFT_TARGET_AVX2 static inline T set1(double a) { return _mm256_set1_pd(a); }
+    FFT_TARGET_AVX2 static inline T add(T a, T b) { return _mm256_add_pd(a, b); }
+    FFT_TARGET_AVX2 static inline T sub(T a, T b) { return _mm256_sub_pd(a, b); }
+    FFT_TARGET_AVX2 static inline T mul(T a, T b) { return _mm256_mul_pd(a, b); }
+    FFT_TARGET_AVX2 static inline T fmadd(T a, T b, T c) { return _mm256_fmadd_pd(a, b, c); }
+    FFT_TARGET_AVX2 static inline T fnmadd(T a, T b, T c) { return _mm256_fnmadd_pd(a, b, c); }
+};
+
+struct AVX512D {
+    using Real = double;
+    using T = __m512d;
+    static const int W = 8;
+    FFT_TARGET_AVX512 static inline T load(const double* p) { return _mm512_loadu_pd(p); }
+    FFT_TARGET_AVX512 static inline void store(double* p, T a) { _mm512_storeu_pd(p, a); }
+    FFT_TARGET_AVX512 static inline T set1(double a) { return _mm512_set1_pd(a); }
+    FFT_TARGET_AVX512 static inline T add(T a, T b) { return _mm512_add_pd(a, b); }
+    FFT_TARGET_AVX512 static inline T sub(T a, T b) { return _mm512_sub_pd(a, b); }
+    FFT_TARGET_AVX512 static inline T mul(T a, T b) { return _mm512_mul_pd(a, b); }
+    FFT_TARGET_AVX512 static inline T fmadd(T a, T b, T c) { return _mm512_fmadd_pd(a, b, c); }
+    FFT_TARGET_AVX512 static inline T fnmadd(T a, T b, T c) { return _mm512_fnmadd_pd(a, b, c); }
+};
+
+struct SSE2F {
+    using Real = float;
+    using T = __m128;
+    static const int W = 4;
+    FFT_TARGET_SSE2 static inline T load(const float* p) { return _mm_loadu_ps(p); }
+    FFT_TARGET_SSE2 static inline void store(float* p, T a) { _mm_storeu_ps(p, a); }
+    FFT_TARGET_SSE2 static inline T set1(float a) { return _mm_set1_ps(a); }
+    FFT_TARGET_SSE2 static inline T add(T a, T b) { return _mm_add_ps(a, b); }
+    FFT_TARGET_SSE2 static inline T sub(T a, T b) { return _mm_sub_ps(a, b); }
+    FFT_TARGET_SSE2 static inline T mul(T a, T b) { return _mm_mul_ps(a, b); }
+    FFT_TARGET_SSE2 static inline T fmadd(T a, T b, T c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    FFT_TARGET_SSE2 static inline T fnmadd(T a, T b, T c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+};
+
+struct AVX2F {
+    using Real = float;
+    using T = __m256;
+    static const int W = 8;
+    FFT_TARGET_AVX2 static inline T load(const float* p) { return _mm256_loadu_ps(p); }
+    FFT_TARGET_AVX2 static inline void store(float* p, T a) { _mm256_storeu_ps(p, a); }
+    FFT_TARGET_AVX2 static inline T set1(float a) { return _mm256_set1_ps(a); }
+    FFT_TARGET_AVX2 static inline T add(T a, T b) { return _mm256_add_ps(a, b); }
+    FFT_TARGET_AVX2 static inline T sub(T a, T b) { return _mm256_sub_ps(a, b); }
+    FFT_TARGET_AVX2 static inline T mul(T a, T b) { return _mm256_mul_ps(a, b); }
+    FFT_TARGET_AVX2 static inline T fmadd(T a, T b, T c) { return _mm256_fmadd_ps(a, b, c); }
+    FFT_TARGET_AVX2 static inline T fnmadd(T a, T b, T c) { return _mm256_fnmadd_ps(a, b, c); }
+};
+
+struct AVX512F {
+    using Real = float;
+    using T = __m512;
+    static const int W = 16;
+    FFT_TARGET_AVX512 static inline T load(const float* p) { return _mm512_loadu_ps(p); }
+    FFT_TARGET_AVX512 static inline void store(float* p, T a) { _mm512_storeu_ps(p, a); }
+    FFT_TARGET_AVX512 static inline T set1(float a) { return _mm512_set1_ps(a); }
+    FFT_TARGET_AVX512 static inline T add(T a, T b) { return _mm512_add_ps(a, b); }
+    FFT_TARGET_AVX512 static inline T sub(T a, T b) { return _mm512_sub_ps(a, b); }
+    FFT_TARGET_AVX512 static inline T mul(T a, T b) { return _mm512_mul_ps(a, b); }
+    FFT_TARGET_AVX512 static inline T fmadd(T a, T b, T c) { return _mm512_fmadd_ps(a, b, c); }
+    FFT_TARGET_AVX512 static inline T fnmadd(T a, T b, T c) { return _mm512_fnmadd_ps(a, b, c); }
+};
+#endif
+
+// Буферы и множители для раздельного БПФ длины N (степень двойки).
+// lanes > 1 - пакет из lanes сигналов: отсчет j сигнала l лежит в re[j * lanes + l],
+// тогда любой этап векторизуется по сигналам, в том числе этапы с малым шагом.
+template <typename Real>
+struct SplitFFTData {
+    int N;
+    bool inverse;
+    const Real* twRe;   // w^k, k = 0..N-1
+    const Real* twIm;
+    Real* re[2];        // два буфера, этапы пишут в них по очереди
+    Real* im[2];
+    int lanes;
+};
+
+// (re + i*im) * (wr + i*wi)
+template <class V>
+FFT_INLINE void complexMul(typename V::T& re, typename V::T& im, const typename V::T& wr, const typename V::T& wi) {
+    typename V::T r = V::fnmadd(im, wi, V::mul(re, wr));
+    im = V::fmadd(re, wi, V::mul(im, wr));
+    re = r;
+}
+
+// Этап по 4: x_j = src[q + s*(p + j*m)], dst[q + s*(4p + k)] = y_k * w^(p*k*ts).
+// s - шаг в массиве, ts - шаг по таблице множителей (s = ts * lanes)
+template <class V, bool Inverse>
+FFT_INLINE void splitRadix4Stage(int m, int s, int ts, const typename V::Real* twRe, const typename V::Real* twIm,
+    const typename V::Real* sr, const typename V::Real* si, typename V::Real* dr, typename V::Real* di) {
+    using T = typename V::T;
+    for (int p = 0; p < m; p++) {
+        T w1r = V::set1(twRe[p * ts]), w1i = V::set1(twIm[p * ts]);
+        T w2r = V::set1(twRe[2 * p * ts]), w2i = V::set1(twIm[2 * p * ts]);
+        T w3r = V::set1(twRe[3 * p * ts]), w3i = V::set1(twIm[3 * p * ts]);
+        const int i0 = s * p, i1 = s * (p + m), i2 = s * (p + 2 * m), i3 = s * (p + 3 * m);
+        const int o0 = s * 4 * p;
+
+        for (int q = 0; q < s; q += V::W) {
+            T x0r = V::load(sr + i0 + q), x0i = V::load(si + i0 + q);
+            T x1r = V::load(sr + i1 + q), x1i = V::load(si + i1 + q);
+            T x2r = V::load(sr + i2 + q), x2i = V::load(si + i2 + q);
+            T x3r = V::load(sr + i3 + q), x3i = V::load(si + i3 + q);
+
+            T ar = V::add(x0r, x2r), ai = V::add(x0i, x2i);
+            T br = V::sub(x0r, x2r), bi = V::sub(x0i, x2i);
+            T cr = V::add(x1r, x3r), ci = V::add(x1i, x3i);
+            T dr_ = V::sub(x1r, x3r), di_ = V::sub(x1i, x3i);
+
+            // -i*d (прямое) или +i*d (обратное)
+            T er = Inverse ? V::sub(V::set1(0), di_) : di_;
+            T ei = Inverse ? dr_ : V::sub(V::set1(0), dr_);
+
+            T y1r = V::add(br, er), y1i = V::add(bi, ei);
+            T y2r = V::sub(ar, cr), y2i = V::sub(ai, ci);
+            T y3r = V::sub(br, er), y3i = V::sub(bi, ei);
+            complexMul<V>(y1r, y1i, w1r, w1i);
+            complexMul<V>(y2r, y2i, w2r, w2i);
+            complexMul<V>(y3r, y3i, w3r, w3i);
+
+            V::store(dr + o0 + q, V::add(ar, cr));
+            V::store(di + o0 + q, V::add(ai, ci));
+            V::store(dr + o0 + s + q, y1r);
+            V::store(di + o0 + s + q, y1i);
+            V::store(dr + o0 + 2 * s + q, y2r);
+            V::store(di + o0 + 2 * s + q, y2i);
+            V::store(dr + o0 + 3 * s + q, y3r);
+            V::store(di + o0 + 3 * s + q, y3i);
+        }
+    }
+}
+
+// Этап по 2, x_j = src[q + s*(p + j*m)], dst[q + s*(2p + k)]
+template <class V>
+FFT_INLINE void splitRadix2Stage(int m, int s, int ts, const typename V::Real* twRe, const typename V::Real* twIm,
+    const typename V::Real* sr, const typename V::Real* si, typename V::Real* dr, typename V::Real* di) {
+    using T = typename V::T;
+    for (int p = 0; p < m; p++) {
+        T wr = V::set1(twRe[p * ts]), wi = V::set1(twIm[p * ts]);
+        const int i0 = s * p, i1 = s * (p + m), o0 = s * 2 * p;
+        for (int q = 0; q < s; q += V::W) {
+            T ar = V::load(sr + i0 + q), ai = V::load(si + i0 + q);
+            T br = V::load(sr + i1 + q), bi = V::load(si + i1 + q);
+            T yr = V::sub(ar, br), yi = V::sub(ai, bi);
+            complexMul<V>(yr, yi, wr, wi);
+            V::store(dr + o0 + q, V::add(ar, br));
+            V::store(di + o0 + q, V::add(ai, bi));
+            V::store(dr + o0 + s + q, yr);
+            V::store(di + o0 + s + q, yi);
+        }
+    }
+}
+
+// Все этапы; результат в буфере с возвращаемым номером (вход в буфере 0)
+template <class V, bool Inverse>
+FFT_INLINE int splitStages(const SplitFFTData<typename V::Real>& d) {
+    using S = ScalarOps<typename V::Real>;
+    int cur = 0;
+    int n = d.N, ts = 1;
+    for (; n >= 4; n /= 4, ts *= 4, cur ^= 1) {
+        int s = ts * d.lanes;
+        if (s >= V::W) {
+            splitRadix4Stage<V, Inverse>(n / 4, s, ts, d.twRe, d.twIm, d.re[cur], d.im[cur], d.re[cur ^ 1], d.im[cur ^ 1]);
+        }
+        else {
+            splitRadix4Stage<S, Inverse>(n / 4, s, ts, d.twRe, d.twIm, d.re[cur], d.im[cur], d.re[cur ^ 1], d.im[cur ^ 1]);
+        }
+    }
+    if (n == 2) {
+        int s = ts * d.lanes;
+        if (s >= V::W) {
+            splitRadix2Stage<V>(1, s, ts, d.twRe, d.twIm, d.re[cur], d.im[cur], d.re[cur ^ 1], d.im[cur ^ 1]);
+        }
+        else {
+            splitRadix2Stage<S>(1, s, ts, d.twRe, d.twIm, d.re[cur], d.im[cur], d.re[cur ^ 1], d.im[cur ^ 1]);
+        }
+        cur ^= 1;
+    }
+    return cur;
+}
+
+template <class V>
+FFT_INLINE int splitFFT(const SplitFFTData<typename V::Real>& d) {
+    return d.inverse ? splitStages<V, true>(d) : splitStages<V, false>(d);
+}
+
+int splitFFTScalar(const SplitFFTData<double>& d) { return splitFFT<ScalarD>(d); }
+#ifdef FFT_X86_DISPATCH
+FFT_TARGET_SSE2 int splitFFTSSE2(const SplitFFTData<double>& d) { return splitFFT<SSE2D>(d); }
+FFT_TARGET_AVX2 int splitFFTAVX2(const SplitFFTData<double>& d) { return splitFFT<AVX2D>(d); }
+FFT_TARGET_AVX512 int splitFFTAVX512(const SplitFFTData<double>& d) { return splitFFT<AVX512D>(d); }
+#endif
+
+int splitFFTScalarF(const SplitFFTData<float>& d) { return splitFFT<ScalarF>(d); }
+#ifdef FFT_X86_DISPATCH
+FFT_TARGET_SSE2 int splitFFTSSE2F(const SplitFFTData<float>& d) { return splitFFT<SSE2F>(d); }
+FFT_TARGET_AVX2 int splitFFTAVX2F(const SplitFFTData<float>& d) { return splitFFT<AVX2F>(d); }
+FFT_TARGET_AVX512 int splitFFTAVX512F(const SplitFFTData<float>& d) { return splitFFT<AVX512F>(d); }
+#pragma GCC diagnostic pop
+#endif
+
+template <typename Real>
+using SplitFFTKernelT = int (*)(const SplitFFTData<Real>&);
+using SplitFFTKernel = SplitFFTKernelT<double>;
+
+// Число Real в регистре, столько сигналов считает пакетное ядро за раз
+template <typename Real = double>
+int simdWidth(SimdLevel level) {
+    int bytes = level == SimdLevel::AVX512 ? 64 : level == SimdLevel::AVX2 ? 32 : level == SimdLevel::SSE2 ? 16 : 0;
+    return max(1, bytes / (int)sizeof(Real));
+}
+
+template <typename Real = double>
+SplitFFTKernelT<Real> splitKernel(SimdLevel level) {
+    if constexpr (is_same<Real, float>::value) {
+#ifdef FFT_X86_DISPATCH
+        switch (level) {
+        case SimdLevel::AVX512: return splitFFTAVX512F;
+        case SimdLevel::AVX2: return splitFFTAVX2F;
+        case SimdLevel::SSE2: return splitFFTSSE2F;
+        default: break;
+        }
+#endif
+        (void)level;
+        return splitFFTScalarF;
+    }
+    else {
+#ifdef FFT_X86_DISPATCH
+        switch (level) {
+        case SimdLevel::AVX512: return splitFFTAVX512;
+        case SimdLevel::AVX2: return splitFFTAVX2;
+        case SimdLevel::SSE2: return splitFFTSSE2;
+        default: break;
+        }
+#endif
+        (void)level;
+        return splitFFTScalar;
+    }
+}
+
+// ==================== КОДЛЕТЫ ФИКСИРОВАННОГО РАЗМЕРА ====================
+
+// Для размеров, известных при компиляции, БПФ разворачивается шаблонами:
+// этапы по основанию 4 - рекурсия FixedFFT<N> -> четыре FixedFFT<N/4> (при N = 8
+// один этап по основанию 2 над двумя FixedFFT<4>), множители - constexpr-таблицы,
+// без тригонометрии во время работы, без циклов по этапам и без кучи.
+
+constexpr long double FIXED_PI = 3.141592653589793238462643383279502884L;
+
+// sin и cos в C++17 не constexpr: ряд Тейлора после приведения угла к [-pi, pi]
+constexpr long double fixedSinCos(long double x, bool cosine) {
+    while (x > FIXED_PI) x -= 2 * FIXED_PI;
+    while (x < -FIXED_PI) x += 2 * FIXED_PI;
+    long double term = cosine ? 1.0L : x;
+    long double sum = term;
+    for (int n = cosine ? 1 : 2; n < 60; n += 2) {
+        term *= -x * x / ((long double)n * (n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// w^k = exp(-2*pi*i*k/N), k = 0..N/2-1
+template <int N>
+struct FixedTwiddles {
+    double re[N / 2 > 0 ? N / 2 : 1];
+    double im[N / 2 > 0 ? N / 2 : 1];
+};
+
+template <int N>
+constexpr FixedTwiddles<N> makeFixedTwiddles() {
+    FixedTwiddles<N> table{};
+    for (int k = 0; k < N / 2; k++) {
+        long double angle = -2 * FIXED_PI * k / N;
+        table.re[k] = (double)fixedSinCos(angle, true);
+        table.im[k] = (double)fixedSinCos(angle, false);
+    }
+    return table;
+}
+
+template <int N>
+struct FixedTwiddleTable {
+    static constexpr FixedTwiddles<N> value = makeFixedTwiddles<N>();
+};
+
+// w^k * (re + i*im); умножение расписано по компонентам: operator* у complex проверяет NaN/inf
+template <int N, bool Inverse, typename Real>
+FFT_INLINE complex<Real> fixedTwiddle(int k, const complex<Real>& z) {
+    constexpr const FixedTwiddles<N>& w = FixedTwiddleTable<N>::value;
+    // k < N: w^k = -w^(k - N/2)
+    Real sign = k < N / 2 ? Real(1) : Real(-1);
+    int j = k < N / 2 ? k : k - N / 2;
+    Real wr = sign * Real(w.re[j]), wi = sign * Real(Inverse ? -w.im[j] : w.im[j]);
+    return complex<Real>(z.real() * wr - z.imag() * wi, z.real() * wi + z.imag() * wr);
+}
+
+// ±i * z: -i для прямого, +i для обратного
+template <bool Inverse, typename Real>
+FFT_INLINE complex<Real> fixedRotate(const complex<Real>& z) {
+    return Inverse ? complex<Real>(-z.imag(), z.real()) : complex<Real>(z.imag(), -z.real());
+}
+
+// out[k] = sum_n in[n * stride] w^(nk), прореживание по времени по основанию 4:
+// четыре подпреобразования длины N/4 и одна бабочка на каждую четверку выходов.
+// Обратное - без деления на N.
+template <int N, bool Inverse, typename Real>
+struct FixedFFT {
+    static_assert(N >= 16 && (N & (N - 1)) == 0, "FixedFFT: N - степень двойки");
+    using ComplexT = complex<Real>;
+
+    static inline void run(const ComplexT* in, int stride, ComplexT* out) {
+        constexpr int Q = N / 4;
+        FixedFFT<Q, Inverse, Real>::run(in, 4 * stride, out);
+        FixedFFT<Q, Inverse, Real>::run(in + stride, 4 * stride, out + Q);
+        FixedFFT<Q, Inverse, Real>::run(in + 2 * stride, 4 * stride, out + 2 * Q);
+        FixedFFT<Q, Inverse, Real>::run(in + 3 * stride, 4 * stride, out + 3 * Q);
+        for (int k = 0; k < Q; k++) {
+            ComplexT x0 = out[k];
+            ComplexT x1 = fixedTwiddle<N, Inverse>(k, out[k + Q]);
+            ComplexT x2 = fixedTwiddle<N, Inverse>(2 * k, out[k + 2 * Q]);
+            ComplexT x3 = fixedTwiddle<N, Inverse>(3 * k, out[k + 3 * Q]);
+            ComplexT a = x0 + x2, b = x0 - x2, c = x1 + x3, d = fixedRotate<Inverse>(x1 - x3);
+            out[k] = a + c;
+            out[k + Q] = b + d;
+            out[k + 2 * Q] = a - c;
+            out[k + 3 * Q] = b - d;
+        }
+    }
+};
+
+// 8 = 2 x 4: последний этап по основанию 2
+template <bool Inverse, typename Real>
+struct FixedFFT<8, Inverse, Real> {
+    using ComplexT = complex<Real>;
+
+    static FFT_INLINE void run(const ComplexT* in, int stride, ComplexT* out) {
+        FixedFFT<4, Inverse, Real>::run(in, 2 * stride, out);
+        FixedFFT<4, Inverse, Real>::run(in + stride, 2 * stride, out + 4);
+        for (int k = 0; k < 4; k++) {
+            ComplexT a = out[k], t = fixedTwiddle<8, Inverse>(k, out[k + 4]);
+            out[k] = a + t;
+            out[k + 4] = a - t;
+        }
+    }
+};
+
+template <bool Inverse, typename Real>
+struct FixedFFT<4, Inverse, Real> {
+    using ComplexT = complex<Real>;
+
+    static FFT_INLINE void run(const ComplexT* in, int stride, ComplexT* out) {
+        ComplexT x0 = in[0], x1 = in[stride], x2 = in[2 * stride], x3 = in[3 * stride];
+        ComplexT a = x0 + x2, b = x0 - x2, c = x1 + x3, e = fixedRotate<Inverse>(x1 - x3);
+        out[0] = a + c;
+        out[1] = b + e;
+        out[2] = a - c;
+        out[3] = b - e;
+    }
+};
+
+template <bool Inverse, typename Real>
+struct FixedFFT<2, Inverse, Real> {
+    using ComplexT = complex<Real>;
+
+    static FFT_INLINE void run(const ComplexT* in, int stride, ComplexT* out) {
+        ComplexT x0 = in[0], x1 = in[stride];
+        out[0] = x0 + x1;
+        out[1] = x0 - x1;
+    }
+};
+
+// Размеры, для которых есть кодлеты; FFTPlan выбирает их сам (512 - только если
+// нет SIMD-ядер или Measure показал, что кодлет быстрее)
+template <typename Real>
+using FixedFFTCodelet = void (*)(const complex<Real>*, complex<Real>*);
+
+template <int N, bool Inverse, typename Real>
+void fixedCodelet(const complex<Real>* in, complex<Real>* out) {
+    FixedFFT<N, Inverse, Real>::run(in, 1, out);
+}
+
+template <typename Real, bool Inverse>
+FixedFFTCodelet<Real> findFixedCodelet(int N) {
+    switch (N) {
+    case 8: return fixedCodelet<8, Inverse, Real>;
+    case 16: return fixedCodelet<16, Inverse, Real>;
+    case 32: return fixedCodelet<32, Inverse, Real>;
+    case 64: return fixedCodelet<64, Inverse, Real>;
+    case 512: return fixedCodelet<512, Inverse, Real>;
+    default: return nullptr;
+    }
+}
+
+// nullptr, если кодлета размера N нет
+template <typename Real>
+FixedFFTCodelet<Real> findFixedCodelet(int N, bool inverse) {
+    return inverse ? findFixedCodelet<Real, true>(N) : findFixedCodelet<Real, false>(N);
+}
+
+// БПФ длины N, известной при компиляции: данные на стеке, без плана
+template <int N, typename Real = double>
+array<complex<Real>, N> fft(const array<complex<Real>, N>& input) {
+    array<complex<Real>, N> output;
+    FixedFFT<N, false, Real>::run(input.data(), 1, output.data());
+    return output;
+}
+
+template <int N, typename Real = double>
+array<complex<Real>, N> ifft(const array<complex<Real>, N>& input) {
+    array<complex<Real>, N> output;
+    FixedFFT<N, true, Real>::run(input.data(), 1, output.data());
+    for (complex<Real>& value : output) value *= Real(1) / Real(N);
+    return output;
+}
+
+// ==================== ПЛАНЫ БПФ ====================
+
+// Распределитель с выравниванием на 64 байта (строка кэша, регистр AVX-512)
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+    static constexpr size_t ALIGNMENT = 64;
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(ALIGNMENT)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, align_val_t(ALIGNMENT));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using AlignedVector = vector<T, AlignedAllocator<T>>;
+
+enum class FFTStrategy {
+    Radix2,      // бит-реверсная перестановка + этапы по 2
+    Radix4,      // бит-реверсная перестановка + сдвоенные этапы (2 x 2)
+    Stockham,    // автосортировка по 2, без перестановки, через буфер
+    MixedRadix,  // автосортировка с основаниями 4, 2, 3, 5, 7 и любым малым простым
+    Bluestein,   // линейная свертка с чирпом через БПФ степени двойки, любое N
+    SplitSIMD,   // SIMD-ядра на раздельных re/im массивах, степень двойки, double или float
+    Codelet      // развернутое при компиляции FixedFFT<N>, N = 8, 16, 32, 64, 512
+};
+
+enum class FFTPlanning {
+    Estimate,  // стратегия выбирается по размеру
+    Measure    // все подходящие стратегии замеряются при создании плана
+};
+
+// Простые множители N больше этого числа считаются алгоритмом Блюстейна
+const int FFT_MAX_RADIX = 64;
+
+// План БПФ для фиксированных (N, направление, точность).
+// Множители, расписание этапов и буферы готовятся в конструкторе,
+// execute() память не выделяет. Обратный план делит результат на N.
+// Один план нельзя одновременно выполнять из нескольких потоков (общий буфер).
+template <typename Real>
+class FFTPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    FFTPlanT(int N, bool inverse = false, FFTPlanning planning = FFTPlanning::Estimate)
+        : N(N), inverse_(inverse) {
+        if (N < 1) {
+            throw invalid_argument("FFTPlan: N должно быть положительным");
+        }
+
+        twiddles.resize(N);
+        for (int k = 0; k < N; k++) {
+            twiddles[k] = toReal(polar(1.0, sign() * 2 * PI * k / N));
+        }
+        scratch.resize(N);
+
+        vector<FFTStrategy> candidates;
+        bool smooth = prepareMixedRadix();
+        if (isPowerOfTwo(N)) {
+            prepareBitReversal();
+            candidates = { FFTStrategy::Radix4, FFTStrategy::Radix2, FFTStrategy::Stockham, FFTStrategy::MixedRadix };
+            if (prepareSplit()) {
+                if (N >= SPLIT_MIN_SIZE) candidates.insert(candidates.begin(), FFTStrategy::SplitSIMD);
+                else candidates.push_back(FFTStrategy::SplitSIMD);
+            }
+            codelet_ = findFixedCodelet<Real>(N, inverse);
+            if (codelet_) {
+                bool simd_first = candidates[0] == FFTStrategy::SplitSIMD;
+                if (N <= CODELET_MAX_PREFERRED || !simd_first) candidates.insert(candidates.begin(), FFTStrategy::Codelet);
+                else candidates.insert(candidates.begin() + 1, FFTStrategy::Codelet);
+            }
+        }
+        else {
+            if (smooth) candidates.push_back(FFTStrategy::MixedRadix);
+            candidates.push_back(FFTStrategy::Bluestein);
+        }
+
+        if (planning == FFTPlanning::Measure && candidates.size() > 1) {
+            if (!isPowerOfTwo(N)) prepareBluestein();
+            strategy_ = measureStrategy(candidates);
+        }
+        else {
+            strategy_ = candidates[0];
+        }
+
+        if (strategy_ == FFTStrategy::Bluestein) {
+            if (!bluesteinForward) prepareBluestein();
+        }
+        else {
+            releaseBluestein();
+        }
+        if (strategy_ != FFTStrategy::SplitSIMD) {
+            AlignedVector<Real>().swap(splitTwiddles);
+            AlignedVector<Real>().swap(splitBuffer);
+        }
+    }
+
+    int size() const { return N; }
+    bool inverse() const { return inverse_; }
+    FFTStrategy strategy() const { return strategy_; }
+
+    // in и out могут совпадать
+    void execute(const ComplexT* in, ComplexT* out) {
+        run(strategy_, in, out);
+    }
+
+    // out должен иметь размер N (иначе он один раз расширяется)
+    void execute(const vector<ComplexT>& in, vector<ComplexT>& out) {
+        if ((int)in.size() != N) {
+            throw invalid_argument("FFTPlan::execute: размер входа не совпадает с планом");
+        }
+        if ((int)out.size() != N) out.resize(N);
+        execute(in.data(), out.data());
+    }
+
+    // На месте: бит-реверсная перестановка и этапы идут прямо в data
+    void execute(vector<ComplexT>& data) {
+        if ((int)data.size() != N) {
+            throw invalid_argument("FFTPlan::execute: размер входа не совпадает с планом");
+        }
+        execute(data.data(), data.data());
+    }
+
+private:
+    // Один этап автосортировки: длина подпреобразований n = radix * m, шаг s
+    struct Stage {
+        int radix, m, s;
+        int trig;   // смещение таблиц cos/sin для нечетного основания
+    };
+
+    int N;
+    bool inverse_;
+    FFTStrategy strategy_ = FFTStrategy::Radix4;
+    AlignedVector<ComplexT> twiddles;   // w^k, k = 0..N-1, знак по направлению
+    AlignedVector<ComplexT> scratch;
+    vector<int> bitrev;
+
+    vector<Stage> stages;
+    AlignedVector<Real> radixCos, radixSin;   // cos(2*pi*t/r), sign * sin(2*pi*t/r)
+
+    int bluesteinSize = 0;                    // M >= 2N - 1, степень двойки
+    AlignedVector<ComplexT> chirp;            // exp(sign * i * pi * n^2 / N)
+    AlignedVector<ComplexT> chirpSpectrum;    // БПФ длины M от сопряженного чирпа
+    AlignedVector<ComplexT> bluesteinBuffer;
+    unique_ptr<FFTPlanT> bluesteinForward, bluesteinInverse;
+
+    // Раздельное хранение: с этого N SIMD-путь выбирается без замеров
+    static const int SPLIT_MIN_SIZE = 16;
+    AlignedVector<Real> splitTwiddles;   // re[0..N), im[0..N)
+    AlignedVector<Real> splitBuffer;     // два буфера re/im по N
+    SplitFFTKernelT<Real> splitKernel_ = nullptr;
+
+    // До этого N кодлет быстрее SIMD-ядер (по замерам), дальше он только кандидат для Measure
+    static const int CODELET_MAX_PREFERRED = 64;
+    FixedFFTCodelet<Real> codelet_ = nullptr;
+
+    double sign() const { return inverse_ ? 1.0 : -1.0; }
+
+    static ComplexT toReal(const complex<double>& z) {
+        return ComplexT(Real(z.real()), Real(z.imag()));
+    }
+
+    // i * z
+    static ComplexT mulI(const ComplexT& z) {
+        return ComplexT(-z.imag(), z.real());
+    }
+
+    void prepareBitReversal() {
+        bitrev.resize(N);
+        int bits = 0;
+        while ((1 << bits) < N) bits++;
+        for (int i = 0; i < N; i++) {
+            int r = 0;
+            for (int b = 0; b < bits; b++) {
+                r |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitrev[i] = r;
+        }
+    }
+
+    // Разложение N на основания этапов; false, если есть простой множитель > FFT_MAX_RADIX
+    bool prepareMixedRadix() {
+        vector<int> radices;
+        int rest = N;
+        while (rest % 4 == 0) { radices.push_back(4); rest /= 4; }
+        while (rest % 2 == 0) { radices.push_back(2); rest /= 2; }
+        for (int p = 3; p * p <= rest; p += 2) {
+            while (rest % p == 0) { radices.push_back(p); rest /= p; }
+        }
+        if (rest > 1) radices.push_back(rest);
+
+        for (int r : radices) {
+            if (r > FFT_MAX_RADIX) {
+                stages.clear();
+                return false;
+            }
+        }
+
+        int s = 1;
+        for (int r : radices) {
+            Stage stage = { r, N / (s * r), s, (int)radixCos.size() };
+            if (r % 2 == 1) {
+                for (int t = 0; t < r; t++) {
+                    radixCos.push_back(Real(cos(2 * PI * t / r)));
+                    radixSin.push_back(Real(sign() * sin(2 * PI * t / r)));
+                }
+            }
+            stages.push_back(stage);
+            s *= r;
+        }
+        return true;
+    }
+
+    void prepareBluestein() {
+        bluesteinSize = 1;
+        while (bluesteinSize < 2 * N - 1) bluesteinSize <<= 1;
+        int M = bluesteinSize;
+
+        chirp.resize(N);
+        for (long long n = 0; n < N; n++) {
+            long long n2 = n * n % (2LL * N);   // период чирпа по n^2 равен 2N
+            chirp[n] = toReal(polar(1.0, sign() * PI * n2 / N));
+        }
+
+        bluesteinForward.reset(new FFTPlanT(M, false));
+        bluesteinInverse.reset(new FFTPlanT(M, true));
+
+        chirpSpectrum.assign(M, ComplexT(0));
+        chirpSpectrum[0] = conj(chirp[0]);
+        for (int n = 1; n < N; n++) {
+            chirpSpectrum[n] = conj(chirp[n]);
+            chirpSpectrum[M - n] = conj(chirp[n]);
+        }
+        bluesteinForward->execute(chirpSpectrum.data(), chirpSpectrum.data());
+        bluesteinBuffer.resize(M);
+    }
+
+    // Ядра есть для double и float; false - стратегия недоступна
+    bool prepareSplit() {
+        if constexpr (is_same<Real, double>::value || is_same<Real, float>::value) {
+            splitTwiddles.resize(2 * N);
+            for (int k = 0; k < N; k++) {
+                splitTwiddles[k] = twiddles[k].real();
+                splitTwiddles[N + k] = twiddles[k].imag();
+            }
+            splitBuffer.resize(4 * N);
+            splitKernel_ = splitKernel<Real>(activeSimdLevel());
+            return true;
+        }
+        return false;
+    }
+
+    // Адаптер: чередующиеся complex -> раздельные массивы -> complex
+    void splitSIMD(const ComplexT* in, ComplexT* out) {
+        if constexpr (is_same<Real, double>::value || is_same<Real, float>::value) {
+            Real* re0 = splitBuffer.data();
+            Real* im0 = re0 + N;
+            Real* re1 = re0 + 2 * N;
+            Real* im1 = re0 + 3 * N;
+            for (int i = 0; i < N; i++) {
+                re0[i] = in[i].real();
+                im0[i] = in[i].imag();
+            }
+            SplitFFTData<Real> data = { N, inverse_, splitTwiddles.data(), splitTwiddles.data() + N,
+                { re0, re1 }, { im0, im1 }, 1 };
+            int result = splitKernel_(data);
+            const Real* re = data.re[result];
+            const Real* im = data.im[result];
+            for (int i = 0; i < N; i++) out[i] = ComplexT(re[i], im[i]);
+        }
+        else {
+            (void)in; (void)out;
+        }
+    }
+
+    void releaseBluestein() {
+        bluesteinSize = 0;
+        bluesteinForward.reset();
+        bluesteinInverse.reset();
+        AlignedVector<ComplexT>().swap(chirp);
+        AlignedVector<ComplexT>().swap(chirpSpectrum);
+        AlignedVector<ComplexT>().swap(bluesteinBuffer);
+    }
+
+    void run(FFTStrategy strategy, const ComplexT* in, ComplexT* out) {
+        if (N == 1) {
+            out[0] = in[0];
+        }
+        else if (strategy == FFTStrategy::Stockham) {
+            stockham(in, out);
+        }
+        else if (strategy == FFTStrategy::MixedRadix) {
+            mixedRadix(in, out);
+        }
+        else if (strategy == FFTStrategy::Bluestein) {
+            bluestein(in, out);
+        }
+        else if (strategy == FFTStrategy::SplitSIMD) {
+            splitSIMD(in, out);
+        }
+        else if (strategy == FFTStrategy::Codelet) {
+            // кодлет читает вход вразброс, пока пишет выход
+            if (in == out) {
+                copy(in, in + N, scratch.data());
+                in = scratch.data();
+            }
+            codelet_(in, out);
+        }
+        else {
+            permute(in, out);
+            if (strategy == FFTStrategy::Radix2) radix2Stages(out);
+            else radix4Stages(out);
+        }
+
+        if (inverse_) {
+            Real scale = Real(1) / Real(N);
+            for (int i = 0; i < N; i++) out[i] *= scale;
+        }
+    }
+
+    void permute(const ComplexT* in, ComplexT* out) const {
+        if (in == out) {
+            for (int i = 0; i < N; i++) {
+                if (i < bitrev[i]) swap(out[i], out[bitrev[i]]);
+            }
+        }
+        else {
+            for (int i = 0; i < N; i++) out[bitrev[i]] = in[i];
+        }
+    }
+
+    void radix2Stage(ComplexT* data, int len) const {
+        int half = len / 2;
+        int step = N / len;
+        for (int start = 0; start < N; start += len) {
+            for (int k = 0; k < half; k++) {
+                ComplexT u = data[start + k];
+                ComplexT v = data[start + k + half] * twiddles[k * step];
+                data[start + k] = u + v;
+                data[start + k + half] = u - v;
+            }
+        }
+    }
+
+    void radix2Stages(ComplexT* data) const {
+        for (int len = 2; len <= N; len <<= 1) radix2Stage(data, len);
+    }
+
+    // Два соседних этапа по 2 за один проход: 3 умножения на 4 точки вместо 4
+    void radix4Stages(ComplexT* data) const {
+        int len = 2;
+        // При нечетном log2(N) первый этап делается отдельно
+        if ((N & 0x55555555) == 0) {
+            radix2Stage(data, 2);
+            len = 4;
+        }
+        for (; len * 2 <= N; len *= 4) {
+            int m = len / 2;                   // четверть блока размера 4m
+            int step2 = N / (2 * m), step4 = N / (4 * m);
+            for (int start = 0; start < N; start += 4 * m) {
+                for (int k = 0; k < m; k++) {
+                    ComplexT t = twiddles[k * step2];
+                    ComplexT s = twiddles[k * step4];
+                    ComplexT a0 = data[start + k];
+                    ComplexT a1 = data[start + k + m] * t;
+                    ComplexT a2 = data[start + k + 2 * m];
+                    ComplexT a3 = data[start + k + 3 * m] * t;
+
+                    ComplexT c0 = a0 + a1, c1 = a0 - a1;
+                    ComplexT c2 = (a2 + a3) * s, c3 = (a2 - a3) * s;
+                    // умножение на w^(N/4) = -i (прямое) или +i (обратное)
+                    c3 = inverse_ ? mulI(c3) : -mulI(c3);
+
+                    data[start + k] = c0 + c2;
+                    data[start + k + 2 * m] = c0 - c2;
+                    data[start + k + m] = c1 + c3;
+                    data[start + k + 3 * m] = c1 - c3;
+                }
+            }
+        }
+    }
+
+    // Автосортировка: на каждом этапе чтение из одного буфера и запись в другой,
+    // буферы чередуются так, чтобы последний этап писал в out
+    template <typename StageFn>
+    void pingPong(int count, const ComplexT* in, ComplexT* out, StageFn stage) {
+        const ComplexT* src = in;
+        for (int i = 0; i < count; i++) {
+            ComplexT* dst = ((count - 1 - i) % 2 == 0) ? out : scratch.data();
+            if (src == dst) {
+                // in == out: вход сначала уходит в буфер
+                copy(src, src + N, scratch.data());
+                src = scratch.data();
+            }
+            stage(i, src, dst);
+            src = dst;
+        }
+    }
+
+    void stockham(const ComplexT* in, ComplexT* out) {
+        int count = 0;
+        while ((1 << count) < N) count++;
+
+        pingPong(count, in, out, [&](int i, const ComplexT* src, ComplexT* dst) {
+            int s = 1 << i;
+            int m = (N >> i) / 2;
+            for (int p = 0; p < m; p++) {
+                ComplexT w = twiddles[p * s];
+                for (int q = 0; q < s; q++) {
+                    ComplexT a = src[q + s * p];
+                    ComplexT b = src[q + s * (p + m)];
+                    dst[q + s * 2 * p] = a + b;
+                    dst[q + s * (2 * p + 1)] = (a - b) * w;
+                }
+            }
+        });
+    }
+
+    // Малое ДПФ длины r (R = r известно при компиляции или R = 0)
+    template <int R>
+    void butterfly(const Stage& stage, const ComplexT* x, ComplexT* y) const {
+        const int r = R > 0 ? R : stage.radix;
+        if (R == 2) {
+            y[0] = x[0] + x[1];
+            y[1] = x[0] - x[1];
+        }
+        else if (R == 4) {
+            ComplexT a = x[0] + x[2], b = x[0] - x[2];
+            ComplexT c = x[1] + x[3], d = x[1] - x[3];
+            d = inverse_ ? mulI(d) : -mulI(d);
+            y[0] = a + c;
+            y[2] = a - c;
+            y[1] = b + d;
+            y[3] = b - d;
+        }
+        else {
+            // Нечетное r: пары x_j и x_{r-j} дают вещественные cos- и sin-суммы,
+            // y_k и y_{r-k} отличаются только знаком sin-части
+            const Real* cs = &radixCos[stage.trig];
+            const Real* sn = &radixSin[stage.trig];
+            const int h = (r - 1) / 2;
+            ComplexT sum[FFT_MAX_RADIX / 2], diff[FFT_MAX_RADIX / 2];
+            y[0] = x[0];
+            for (int j = 1; j <= h; j++) {
+                sum[j - 1] = x[j] + x[r - j];
+                diff[j - 1] = x[j] - x[r - j];
+                y[0] += sum[j - 1];
+            }
+            for (int k = 1; k <= h; k++) {
+                ComplexT a = x[0], b = 0;
+                int t = 0;
+                for (int j = 1; j <= h; j++) {
+                    t += k;
+                    if (t >= r) t -= r;
+                    a += sum[j - 1] * cs[t];
+                    b += diff[j - 1] * sn[t];
+                }
+                y[k] = a + mulI(b);
+                y[r - k] = a - mulI(b);
+            }
+        }
+    }
+
+    template <int R>
+    void mixedStage(const Stage& stage, const ComplexT* src, ComplexT* dst) const {
+        const int r = R > 0 ? R : stage.radix;
+        const int m = stage.m, s = stage.s;
+        ComplexT x[FFT_MAX_RADIX], y[FFT_MAX_RADIX], w[FFT_MAX_RADIX];
+
+        for (int p = 0; p < m; p++) {
+            // множители w_n^(p*k), n = r * m, одни и те же для всех q
+            for (int k = 1; k < r; k++) w[k] = twiddles[p * k * s];
+            for (int q = 0; q < s; q++) {
+                for (int j = 0; j < r; j++) x[j] = src[q + s * (p + j * m)];
+                butterfly<R>(stage, x, y);
+                ComplexT* d = dst + q + s * r * p;
+                d[0] = y[0];
+                for (int k = 1; k < r; k++) d[s * k] = y[k] * w[k];
+            }
+        }
+    }
+
+    void mixedRadix(const ComplexT* in, ComplexT* out) {
+        pingPong(stages.size(), in, out, [&](int i, const ComplexT* src, ComplexT* dst) {
+            const Stage& stage = stages[i];
+            switch (stage.radix) {
+            case 2: mixedStage<2>(stage, src, dst); break;
+            case 3: mixedStage<3>(stage, src, dst); break;
+            case 4: mixedStage<4>(stage, src, dst); break;
+            case 5: mixedStage<5>(stage, src, dst); break;
+            case 7: mixedStage<7>(stage, src, dst); break;
+            default: mixedStage<0>(stage, src, dst); break;
+            }
+        });
+    }
+
+    // X_k = c_k * sum_n (x_n c_n) * conj(c_{k-n}), c_n = exp(sign * i * pi * n^2 / N):
+    // свертка считается двумя БПФ длины M, спектр conj(c) готов заранее
+    void bluestein(const ComplexT* in, ComplexT* out) {
+        int M = bluesteinSize;
+        ComplexT* buffer = bluesteinBuffer.data();
+        for (int n = 0; n < N; n++) buffer[n] = in[n] * chirp[n];
+        fill(buffer + N, buffer + M, ComplexT(0));
+
+        bluesteinForward->execute(buffer, buffer);
+        for (int i = 0; i < M; i++) buffer[i] *= chirpSpectrum[i];
+        bluesteinInverse->execute(buffer, buffer);
+
+        for (int k = 0; k < N; k++) out[k] = buffer[k] * chirp[k];
+    }
+
+    // Вход не меняется между запусками (out-of-place): при преобразовании на месте
+    // амплитуда росла бы в sqrt(N) раз за проход и замер шел бы на inf/NaN
+    FFTStrategy measureStrategy(const vector<FFTStrategy>& candidates) {
+        AlignedVector<ComplexT> input(N), output(N);
+        for (int i = 0; i < N; i++) input[i] = ComplexT(Real(i % 7), Real(i % 3));
+        int repeats = max(1, (1 << 18) / N);
+        vector<long long> best_time(candidates.size(), -1);
+
+        // Несколько чередующихся раундов, берется минимум: меньше влияние шума
+        for (int round = 0; round < 3; round++) {
+            for (size_t c = 0; c < candidates.size(); c++) {
+                run(candidates[c], input.data(), output.data());   // прогрев
+                auto start = high_resolution_clock::now();
+                for (int r = 0; r < repeats; r++) run(candidates[c], input.data(), output.data());
+                long long elapsed = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+                if (best_time[c] < 0 || elapsed < best_time[c]) best_time[c] = elapsed;
+            }
+        }
+        int best = min_element(best_time.begin(), best_time.end()) - best_time.begin();
+        return candidates[best];
+    }
+};
+
+using FFTPlan = FFTPlanT<double>;
+
+// Одинарная точность: для 16-битных отсчетов double не нужен, а в SIMD-регистр
+// входит вдвое больше float. Ошибка относительно точного спектра
+// ||X_float - X||_2 / ||X||_2 <= fftErrorBound<float>(N) (проверяется в --bench).
+using FFTPlanF = FFTPlanT<float>;
+
+// Оценка относительной среднеквадратичной ошибки БПФ в точности Real:
+// каждый из log2(N) этапов вносит порядка eps (бабочка и множитель),
+// ошибки этапов некоррелированы и складываются по норме. FFT_ERROR_FACTOR
+// взят с запасом для округления входа и алгоритма Блюстейна (три БПФ длины >= 2N)
+const double FFT_ERROR_FACTOR = 2.0;
+
+template <typename Real>
+double fftErrorBound(int N) {
+    double eps = numeric_limits<Real>::epsilon() / 2;   // единица округления
+    return FFT_ERROR_FACTOR * eps * max(1.0, log2((double)nextPowerOfTwo(N)));
+}
+
+// Планы, созданные при вызовах fft/ifft, свои у каждого потока
+template <typename Real = double>
+FFTPlanT<Real>& cachedPlan(int N, bool inverse) {
+    thread_local map<pair<int, bool>, unique_ptr<FFTPlanT<Real>>> plans;
+    unique_ptr<FFTPlanT<Real>>& plan = plans[{ N, inverse }];
+    if (!plan) plan.reset(new FFTPlanT<Real>(N, inverse));
+    return *plan;
+}
+
+vector<Complex> fft(const vector<Complex>& input) {
+    vector<Complex> output(input.size());
+    cachedPlan(input.size(), false).execute(input, output);
+    return output;
+}
+
+vector<Complex> ifft(const vector<Complex>& input) {
+    vector<Complex> output(input.size());
+    cachedPlan(input.size(), true).execute(input, output);
+    return output;
+}
+
+vector<ComplexF> fft(const vector<ComplexF>& input) {
+    vector<ComplexF> output(input.size());
+    cachedPlan<float>(input.size(), false).execute(input, output);
+    return output;
+}
+
+vector<ComplexF> ifft(const vector<ComplexF>& input) {
+    vector<ComplexF> output(input.size());
+    cachedPlan<float>(input.size(), true).execute(input, output);
+    return output;
+}
+
+// БПФ на месте, без копии входа; inverse = true - обратное (с делением на N)
+void fftInPlace(vector<Complex>& data, bool inverse = false) {
+    cachedPlan(data.size(), inverse).execute(data);
+}
+
+// ==================== ВЕЩЕСТВЕННОЕ БПФ ====================
+
+// БПФ вещественного сигнала длины N. Хранятся только N/2 + 1 неизбыточных
+// частот (X_{N-k} = conj(X_k)). При четном N пары отсчетов упаковываются в одно
+// комплексное число и считается БПФ длины N/2, затем спектры четных и нечетных
+// отсчетов разделяются по эрмитовой симметрии. При нечетном N - полное БПФ.
+// Прямой план: execute(const Real*, ComplexT*), обратный: execute(const ComplexT*, Real*).
+template <typename Real>
+class RealFFTPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    RealFFTPlanT(int N, bool inverse = false, FFTPlanning planning = FFTPlanning::Estimate)
+        : N(N), inverse_(inverse),
+        complexPlan(N % 2 == 0 ? N / 2 : N, inverse, planning) {
+        int H = N / 2;
+        if (N % 2 == 0) {
+            twiddles.resize(H);
+            for (int k = 0; k < H; k++) {
+                complex<double> w = polar(1.0, -2 * PI * k / N);
+                twiddles[k] = ComplexT(Real(w.real()), Real(w.imag()));
+            }
+        }
+        work.resize(complexPlan.size());
+    }
+
+    int size() const { return N; }
+    int spectrumSize() const { return N / 2 + 1; }
+    bool inverse() const { return inverse_; }
+
+    // N отсчетов -> N/2 + 1 частот
+    void execute(const Real* in, ComplexT* out) {
+        if (inverse_) throw logic_error("RealFFTPlan: план создан для обратного преобразования");
+        int H = N / 2;
+        ComplexT* z = work.data();
+
+        if (N % 2 == 1) {
+            for (int n = 0; n < N; n++) z[n] = ComplexT(in[n], 0);
+            complexPlan.execute(z, z);
+            copy(z, z + H + 1, out);
+            return;
+        }
+
+        for (int n = 0; n < H; n++) z[n] = ComplexT(in[2 * n], in[2 * n + 1]);
+        complexPlan.execute(z, z);
+
+        // E_k = (Z_k + conj(Z_{H-k})) / 2, O_k = (Z_k - conj(Z_{H-k})) / 2i, X_k = E_k + w^k O_k
+        ComplexT z0 = z[0];
+        out[0] = ComplexT(z0.real() + z0.imag(), 0);
+        out[H] = ComplexT(z0.real() - z0.imag(), 0);
+        for (int k = 1; k < H; k++) {
+            ComplexT a = z[k], b = conj(z[H - k]);
+            ComplexT even = (a + b) * Real(0.5);
+            ComplexT odd = (a - b) * ComplexT(0, Real(-0.5));
+            out[k] = even + twiddles[k] * odd;
+        }
+    }
+
+    // N/2 + 1 частот -> N отсчетов (с делением на N)
+    void execute(const ComplexT* in, Real* out) {
+        if (!inverse_) throw logic_error("RealFFTPlan: план создан для прямого преобразования");
+        int H = N / 2;
+        ComplexT* z = work.data();
+
+        if (N % 2 == 1) {
+            z[0] = in[0];
+            for (int k = 1; k <= H; k++) {
+                z[k] = in[k];
+                z[N - k] = conj(in[k]);
+            }
+            complexPlan.execute(z, z);
+            for (int n = 0; n < N; n++) out[n] = z[n].real();
+            return;
+        }
+
+        // E_k = (X_k + conj(X_{H-k})) / 2, O_k = (X_k - conj(X_{H-k})) conj(w^k) / 2, Z_k = E_k + i O_k
+        for (int k = 0; k < H; k++) {
+            ComplexT a = in[k], b = conj(in[H - k]);
+            ComplexT even = (a + b) * Real(0.5);
+            ComplexT odd = (a - b) * conj(twiddles[k]) * Real(0.5);
+            z[k] = even + ComplexT(-odd.imag(), odd.real());
+        }
+        complexPlan.execute(z, z);
+        for (int n = 0; n < H; n++) {
+            out[2 * n] = z[n].real();
+            out[2 * n + 1] = z[n].imag();
+        }
+    }
+
+private:
+    int N;
+    bool inverse_;
+    FFTPlanT<Real> complexPlan;
+    AlignedVector<ComplexT> twiddles;   // exp(-2*pi*i*k/N), k < N/2
+    AlignedVector<ComplexT> work;
+};
+
+using RealFFTPlan = RealFFTPlanT<double>;
+using RealFFTPlanF = RealFFTPlanT<float>;
+
+template <typename Real = double>
+RealFFTPlanT<Real>& cachedRealPlan(int N, bool inverse) {
+    thread_local map<pair<int, bool>, unique_ptr<RealFFTPlanT<Real>>> plans;
+    unique_ptr<RealFFTPlanT<Real>>& plan = plans[{ N, inverse }];
+    if (!plan) plan.reset(new RealFFTPlanT<Real>(N, inverse));
+    return *plan;
+}
+
+// Частоты 0..N/2 вещественного сигнала
+vector<Complex> rfft(const vector<double>& input) {
+    int N = input.size();
+    vector<Complex> output(N / 2 + 1);
+    cachedRealPlan(N, false).execute(input.data(), output.data());
+    return output;
+}
+
+// Обратное к rfft; N нужно явно: N/2 + 1 частот дают и N = 2H, и N = 2H + 1
+vector<double> irfft(const vector<Complex>& half_spectrum, int N) {
+    if ((int)half_spectrum.size() != N / 2 + 1) {
+        throw invalid_argument("irfft: ожидается N/2 + 1 частот");
+    }
+    vector<double> output(N);
+    cachedRealPlan(N, true).execute(half_spectrum.data(), output.data());
+    return output;
+}
+
+vector<ComplexF> rfft(const vector<float>& input) {
+    int N = input.size();
+    vector<ComplexF> output(N / 2 + 1);
+    cachedRealPlan<float>(N, false).execute(input.data(), output.data());
+    return output;
+}
+
+vector<float> irfft(const vector<ComplexF>& half_spectrum, int N) {
+    if ((int)half_spectrum.size() != N / 2 + 1) {
+        throw invalid_argument("irfft: ожидается N/2 + 1 частот");
+    }
+    vector<float> output(N);
+    cachedRealPlan<float>(N, true).execute(half_spectrum.data(), output.data());
+    return output;
+}
+
+vector<double> realPart(const vector<Complex>& signal) {
+    vector<double> result(signal.size());
+    for (size_t i = 0; i < signal.size(); i++) {
+        result[i] = signal[i].real();
+    }
+    return result;
+}
+
+// Полный спектр из половины: X_{N-k} = conj(X_k)
+vector<Complex> expandHalfSpectrum(const vector<Complex>& half_spectrum, int N) {
+    vector<Complex> full(N);
+    for (int k = 0; k < N; k++) {
+        full[k] = k <= N / 2 ? half_spectrum[k] : conj(half_spectrum[N - k]);
+    }
+    return full;
+}
+
+// ==================== МНОГОПОТОЧНОЕ БПФ (ШЕСТЬ ШАГОВ) ====================
+
+int defaultThreadCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+// Постоянный пул потоков: они создаются один раз и ждут работы, поэтому
+// parallelFor не создает потоки на каждый вызов (шестишаговое БПФ вызывает его
+// 7 раз за преобразование). run(count, job) вызывает job(t) для t = 0..count-1,
+// номера раздаются по мере освобождения потоков, вызывающий поток тоже работает.
+// Одновременно выполняется одна задача: вложенный или параллельный вызов run
+// выполняет свою задачу последовательно в вызывающем потоке.
+class ThreadPool {
+public:
+    explicit ThreadPool(int workers_count) {
+        for (int t = 0; t < workers_count; t++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_all();
+        for (thread& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // job не должен бросать исключения (parallelFor перехватывает их сам)
+    void run(int count, const function<void(int)>& job) {
+        bool idle = false;
+        if (workers.empty() || count <= 1 || !busy.compare_exchange_strong(idle, true)) {
+            for (int t = 0; t < count; t++) job(t);
+            return;
+        }
+
+        unique_lock<mutex> guard(lock);
+        current = &job;
+        total = count;
+        next = 0;
+        pending = count;
+        wake.notify_all();
+        drain(guard);
+        finished.wait(guard, [&] { return pending == 0; });
+        current = nullptr;
+        total = next = 0;
+        guard.unlock();
+        busy.store(false);
+    }
+
+    // Общий пул на defaultThreadCount() - 1 потоков, создается при первом вызове
+    static ThreadPool& shared();
+
+private:
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake, finished;
+    atomic<bool> busy{ false };
+    const function<void(int)>* current = nullptr;
+    int total = 0, next = 0, pending = 0;
+    bool quit = false;
+
+    // Выполняет оставшиеся номера текущей задачи, на время вызова lock отпускается
+    void drain(unique_lock<mutex>& guard) {
+        while (next < total) {
+            int t = next++;
+            const function<void(int)>& job = *current;
+            guard.unlock();
+            job(t);
+            guard.lock();
+            if (--pending == 0) finished.notify_all();
+        }
+    }
+
+    void workerLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [&] { return quit || next < total; });
+            if (quit) return;
+            drain(guard);
+        }
+    }
+};
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(defaultThreadCount() - 1);
+    return pool;
+}
+
+// body(worker, lo, hi) для равных частей [begin, end); при threads <= 1 - в текущем потоке.
+// worker - номер части (0..threads-1): одновременно каждая часть выполняется одним потоком,
+// поэтому по нему можно выбирать собственные буферы и планы. Части выполняет общий
+// ThreadPool; исключение из любой части пробрасывается после завершения всех.
+template <typename F>
+void parallelFor(int begin, int end, int threads, F&& body) {
+    int count = end - begin;
+    threads = max(1, min(threads, count));
+    if (threads == 1) {
+        if (count > 0) body(0, begin, end);
+        return;
+    }
+    vector<exception_ptr> errors(threads);
+    ThreadPool::shared().run(threads, [&](int t) {
+        int lo = begin + (int)((long long)count * t / threads);
+        int hi = begin + (int)((long long)count * (t + 1) / threads);
+        try {
+            body(t, lo, hi);
+        }
+        catch (...) {
+            errors[t] = current_exception();
+        }
+    });
+    for (exception_ptr& error : errors) {
+        if (error) rethrow_exception(error);
+    }
+}
+
+const int TRANSPOSE_TILE = 32;   // 32 x 32 комплексных чисел = 16 КБ, помещается в L1
+
+// dst (cols x rows) = src (rows x cols)^T, тайлами, строки тайлов делятся между потоками
+template <typename ComplexT>
+void transposeBlocked(const ComplexT* src, ComplexT* dst, int rows, int cols, int threads) {
+    int tile_rows = (rows + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+    parallelFor(0, tile_rows, threads, [&](int, int lo, int hi) {
+        for (int tr = lo; tr < hi; tr++) {
+            int r0 = tr * TRANSPOSE_TILE, r1 = min(rows, r0 + TRANSPOSE_TILE);
+            for (int c0 = 0; c0 < cols; c0 += TRANSPOSE_TILE) {
+                int c1 = min(cols, c0 + TRANSPOSE_TILE);
+                for (int r = r0; r < r1; r++) {
+                    for (int c = c0; c < c1; c++) {
+                        dst[(size_t)c * rows + r] = src[(size_t)r * cols + c];
+                    }
+                }
+            }
+        }
+    });
+}
+
+// Шестишаговое БПФ для больших N = N1 * N2 (n = n1 + N1*n2, k = k2 + N2*k1):
+//   1) транспонирование: строки n1 длины N2;
+//   2) N1 БПФ длины N2 и умножение на w_N^(n1*k2);
+//   3) транспонирование: строки k2 длины N1;
+//   4) N2 БПФ длины N1;
+//   5) транспонирование в естественный порядок k = k2 + N2*k1.
+// Строки делятся между потоками, у каждого потока свои планы строк.
+// Множители w_N^e хранятся двумя таблицами размера ~sqrt(N): w^e = hi[e >> b] * lo[e & mask].
+template <typename Real>
+class ParallelFFTPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    ParallelFFTPlanT(int N, int threads, bool inverse = false)
+        : N(N), threads(max(1, threads)), inverse_(inverse) {
+        N1 = largestDivisorUpToSqrt(N);
+        N2 = N / N1;
+        if (N1 < 2) {
+            throw invalid_argument("ParallelFFTPlan: N не раскладывается на множители");
+        }
+
+        for (int t = 0; t < this->threads; t++) {
+            rowPlans1.emplace_back(new FFTPlanT<Real>(N2, inverse));
+            rowPlans2.emplace_back(new FFTPlanT<Real>(N1, inverse));
+        }
+
+        lowBits = 0;
+        while ((1LL << (2 * lowBits)) < N) lowBits++;
+        int lowSize = 1 << lowBits;
+        int highSize = (int)((N + lowSize - 1) / lowSize);
+        double sign = inverse ? 1.0 : -1.0;
+        twiddleLow.resize(lowSize);
+        twiddleHigh.resize(highSize);
+        for (int i = 0; i < lowSize; i++) {
+            complex<double> w = polar(1.0, sign * 2 * PI * i / N);
+            twiddleLow[i] = ComplexT(Real(w.real()), Real(w.imag()));
+        }
+        for (int i = 0; i < highSize; i++) {
+            complex<double> w = polar(1.0, sign * 2 * PI * ((double)i * lowSize) / N);
+            twiddleHigh[i] = ComplexT(Real(w.real()), Real(w.imag()));
+        }
+
+        work.resize(N);
+    }
+
+    int size() const { return N; }
+    int threadCount() const { return threads; }
+
+    // in и out могут совпадать
+    void execute(const ComplexT* in, ComplexT* out) {
+        ComplexT* a = work.data();
+        int mask = (1 << lowBits) - 1;
+
+        transposeBlocked(in, a, N2, N1, threads);
+
+        parallelFor(0, N1, threads, [&](int worker, int lo, int hi) {
+            for (int n1 = lo; n1 < hi; n1++) {
+                ComplexT* row = a + (size_t)n1 * N2;
+                rowPlans1[worker]->execute(row, row);
+                for (int k2 = 1; k2 < N2; k2++) {
+                    long long e = (long long)n1 * k2;   // < N
+                    row[k2] *= twiddleHigh[e >> lowBits] * twiddleLow[e & mask];
+                }
+            }
+        });
+
+        transposeBlocked(a, out, N1, N2, threads);
+
+        parallelFor(0, N2, threads, [&](int worker, int lo, int hi) {
+            for (int k2 = lo; k2 < hi; k2++) {
+                ComplexT* row = out + (size_t)k2 * N1;
+                rowPlans2[worker]->execute(row, row);
+            }
+        });
+
+        transposeBlocked(out, a, N2, N1, threads);
+        parallelFor(0, N, threads, [&](int, int lo, int hi) {
+            copy(a + lo, a + hi, out + lo);
+        });
+    }
+
+    void execute(const vector<ComplexT>& in, vector<ComplexT>& out) {
+        if ((int)in.size() != N) {
+            throw invalid_argument("ParallelFFTPlan::execute: размер входа не совпадает с планом");
+        }
+        if ((int)out.size() != N) out.resize(N);
+        execute(in.data(), out.data());
+    }
+
+    // Наибольший делитель N, не превосходящий sqrt(N)
+    static int largestDivisorUpToSqrt(int N) {
+        int best = 1;
+        for (int d = 1; (long long)d * d <= N; d++) {
+            if (N % d == 0) best = d;
+        }
+        return best;
+    }
+
+private:
+    int N, N1, N2;
+    int threads;
+    bool inverse_;
+    int lowBits;
+    vector<unique_ptr<FFTPlanT<Real>>> rowPlans1, rowPlans2;   // длины N2 и N1, по плану на поток
+    AlignedVector<ComplexT> twiddleLow, twiddleHigh;
+    AlignedVector<ComplexT> work;
+};
+
+using ParallelFFTPlan = ParallelFFTPlanT<double>;
+
+// Меньшие размеры считаются в одном потоке: запуск потоков дороже самого БПФ
+const int PARALLEL_FFT_MIN_SIZE = 1 << 16;
+
+ParallelFFTPlan& cachedParallelPlan(int N, int threads, bool inverse) {
+    thread_local map<tuple<int, int, bool>, unique_ptr<ParallelFFTPlan>> plans;
+    unique_ptr<ParallelFFTPlan>& plan = plans[make_tuple(N, threads, inverse)];
+    if (!plan) plan.reset(new ParallelFFTPlan(N, threads, inverse));
+    return *plan;
+}
+
+bool useParallelFFT(int N, int threads) {
+    // множитель меньше 16 - строки слишком короткие, выгоды нет
+    return threads > 1 && N >= PARALLEL_FFT_MIN_SIZE &&
+        ParallelFFTPlan::largestDivisorUpToSqrt(N) >= 16;
+}
+
+// threads = 0 - по числу ядер
+vector<Complex> fft(const vector<Complex>& input, int threads) {
+    int N = input.size();
+    if (threads <= 0) threads = defaultThreadCount();
+    if (!useParallelFFT(N, threads)) return fft(input);
+    vector<Complex> output(N);
+    cachedParallelPlan(N, threads, false).execute(input, output);
+    return output;
+}
+
+vector<Complex> ifft(const vector<Complex>& input, int threads) {
+    int N = input.size();
+    if (threads <= 0) threads = defaultThreadCount();
+    if (!useParallelFFT(N, threads)) return ifft(input);
+    vector<Complex> output(N);
+    cachedParallelPlan(N, threads, true).execute(input, output);
+    return output;
+}
+
+// ==================== ПАКЕТНОЕ БПФ ====================
+
+// Для больших N буфер из lanes сигналов не помещается в кэш и выгоднее
+// обычный план на каждый сигнал (по замерам --bench)
+const int BATCH_LANES_MAX_SIZE = 4096;
+
+// howmany сигналов длины N в одном буфере: отсчет j сигнала b лежит в
+// in[b * dist + j * stride] (по умолчанию stride = 1, dist = N * stride), out - так же.
+// Один план на весь пакет. Для степени двойки до BATCH_LANES_MAX_SIZE
+// сигналы идут группами по ширине SIMD-регистра (у float группа вдвое больше): каждая дорожка регистра - свой
+// сигнал. Группы делятся между потоками, у каждого потока свой буфер.
+template <typename Real>
+class BatchFFTPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    BatchFFTPlanT(int N, int howmany, bool inverse = false, int threads = 1, int stride = 1, int dist = -1)
+        : N(N), howmany(howmany), inverse_(inverse), threads(max(1, threads)),
+        stride(stride), dist(dist < 0 ? N * stride : dist) {
+        if (N < 1 || howmany < 0) {
+            throw invalid_argument("BatchFFTPlan: неверные размеры пакета");
+        }
+
+        if constexpr (is_same<Real, double>::value || is_same<Real, float>::value) {
+            SimdLevel level = activeSimdLevel();
+            if (isPowerOfTwo(N) && N >= 2 && N <= BATCH_LANES_MAX_SIZE && simdWidth<Real>(level) > 1) {
+                lanes = simdWidth<Real>(level);
+                kernel = splitKernel<Real>(level);
+                splitTwiddles.resize(2 * N);
+                for (int k = 0; k < N; k++) {
+                    complex<double> w = polar(1.0, (inverse ? 2 : -2) * PI * k / N);
+                    splitTwiddles[k] = Real(w.real());
+                    splitTwiddles[N + k] = Real(w.imag());
+                }
+            }
+        }
+
+        workspaces.resize(this->threads);
+        for (Workspace& ws : workspaces) {
+            if (lanes > 1) {
+                ws.split.resize(4 * (size_t)N * lanes);
+            }
+            else {
+                ws.plan.reset(new FFTPlanT<Real>(N, inverse));
+                ws.line.resize(N);
+            }
+        }
+    }
+
+    int size() const { return N; }
+    int batchSize() const { return howmany; }
+    int signalsPerGroup() const { return lanes; }
+
+    // in и out могут совпадать
+    void execute(const ComplexT* in, ComplexT* out) {
+        int groups = (howmany + lanes - 1) / lanes;
+        parallelFor(0, groups, threads, [&](int worker, int lo, int hi) {
+            Workspace& ws = workspaces[worker];
+            for (int g = lo; g < hi; g++) {
+                if (lanes > 1) runGroup(ws, g, in, out);
+                else runSingle(ws, g, in, out);
+            }
+        });
+    }
+
+private:
+    struct Workspace {
+        AlignedVector<Real> split;          // re0, im0, re1, im1 по N * lanes
+        unique_ptr<FFTPlanT<Real>> plan;    // без SIMD-пакетов: обычный план
+        AlignedVector<ComplexT> line;
+    };
+
+    int N, howmany;
+    bool inverse_;
+    int threads;
+    int stride, dist;
+    int lanes = 1;
+    SplitFFTKernelT<Real> kernel = nullptr;
+    AlignedVector<Real> splitTwiddles;
+    vector<Workspace> workspaces;
+
+    void runSingle(Workspace& ws, int b, const ComplexT* in, ComplexT* out) {
+        const ComplexT* src = in + (size_t)b * dist;
+        ComplexT* dst = out + (size_t)b * dist;
+        for (int j = 0; j < N; j++) ws.line[j] = src[(size_t)j * stride];
+        ws.plan->execute(ws.line.data(), ws.line.data());
+        for (int j = 0; j < N; j++) dst[(size_t)j * stride] = ws.line[j];
+    }
+
+    void runGroup(Workspace& ws, int g, const ComplexT* in, ComplexT* out) {
+        if constexpr (is_same<Real, double>::value || is_same<Real, float>::value) {
+            size_t len = (size_t)N * lanes;
+            Real* re0 = ws.split.data();
+            Real* im0 = re0 + len;
+            Real* re1 = re0 + 2 * len;
+            Real* im1 = re0 + 3 * len;
+            int first = g * lanes;
+            int count = min(lanes, howmany - first);
+
+            // сигналы группы -> дорожки; недостающие дорожки нулевые
+            for (int l = 0; l < lanes; l++) {
+                const ComplexT* src = in + (size_t)(first + l) * dist;
+                for (int j = 0; j < N; j++) {
+                    ComplexT v = l < count ? src[(size_t)j * stride] : ComplexT(0);
+                    re0[(size_t)j * lanes + l] = v.real();
+                    im0[(size_t)j * lanes + l] = v.imag();
+                }
+            }
+
+            SplitFFTData<Real> data = { N, inverse_, splitTwiddles.data(), splitTwiddles.data() + N,
+                { re0, re1 }, { im0, im1 }, lanes };
+            int result = kernel(data);
+            const Real* re = data.re[result];
+            const Real* im = data.im[result];
+
+            Real scale = inverse_ ? Real(1) / Real(N) : Real(1);
+            for (int l = 0; l < count; l++) {
+                ComplexT* dst = out + (size_t)(first + l) * dist;
+                for (int j = 0; j < N; j++) {
+                    dst[(size_t)j * stride] = ComplexT(re[(size_t)j * lanes + l], im[(size_t)j * lanes + l]) * scale;
+                }
+            }
+        }
+        else {
+            (void)ws; (void)g; (void)in; (void)out;
+        }
+    }
+};
+
+using BatchFFTPlan = BatchFFTPlanT<double>;
+using BatchFFTPlanF = BatchFFTPlanT<float>;
+
+// frames - подряд идущие сигналы длины N
+vector<Complex> fftBatch(const vector<Complex>& frames, int N, int threads = 1) {
+    vector<Complex> output(frames.size());
+    BatchFFTPlan plan(N, frames.size() / N, false, threads);
+    plan.execute(frames.data(), output.data());
+    return output;
+}
+
+vector<Complex> ifftBatch(const vector<Complex>& frames, int N, int threads = 1) {
+    vector<Complex> output(frames.size());
+    BatchFFTPlan plan(N, frames.size() / N, true, threads);
+    plan.execute(frames.data(), output.data());
+    return output;
+}
+
+// ==================== ДВУМЕРНОЕ БПФ ====================
+
+// Изображение хранится одним массивом по строкам: элемент (r, c) - data[r * cols + c].
+// Строки преобразуются пакетным БПФ, затем транспонирование тайлами, пакет по
+// бывшим столбцам (теперь строкам) и транспонирование обратно. Строки делятся
+// между потоками.
+template <typename Real>
+class FFT2DPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    FFT2DPlanT(int rows, int cols, bool inverse = false, int threads = 1)
+        : rows(rows), cols(cols), threads(max(1, threads)),
+        rowPass(cols, rows, inverse, threads), columnPass(rows, cols, inverse, threads),
+        transposed((size_t)rows * cols) {}
+
+    int rowCount() const { return rows; }
+    int colCount() const { return cols; }
+
+    // in и out могут совпадать
+    void execute(const ComplexT* in, ComplexT* out) {
+        rowPass.execute(in, out);
+        transposeBlocked(out, transposed.data(), rows, cols, threads);
+        columnPass.execute(transposed.data(), transposed.data());
+        transposeBlocked(transposed.data(), out, cols, rows, threads);
+    }
+
+private:
+    int rows, cols, threads;
+    BatchFFTPlanT<Real> rowPass, columnPass;
+    AlignedVector<ComplexT> transposed;     // cols x rows
+};
+
+using FFT2DPlan = FFT2DPlanT<double>;
+
+// Двумерное БПФ вещественного изображения: строки через RFFT (cols/2 + 1 частот),
+// затем комплексное БПФ столбцов. Спектр rows x (cols/2 + 1), остальные частоты
+// по симметрии X(-k1, -k2) = conj(X(k1, k2)).
+// Прямой план: execute(const Real*, ComplexT*), обратный: execute(const ComplexT*, Real*).
+template <typename Real>
+class RealFFT2DPlanT {
+public:
+    using ComplexT = complex<Real>;
+
+    RealFFT2DPlanT(int rows, int cols, bool inverse = false, int threads = 1)
+        : rows(rows), cols(cols), half(cols / 2 + 1), inverse_(inverse), threads(max(1, threads)),
+        columnPass(rows, cols / 2 + 1, inverse, threads),
+        transposed((size_t)rows * (cols / 2 + 1)) {
+        for (int t = 0; t < this->threads; t++) {
+            rowPlans.emplace_back(new RealFFTPlanT<Real>(cols, inverse));
+        }
+        if (inverse) spectrum.resize(transposed.size());
+    }
+
+    int rowCount() const { return rows; }
+    int colCount() const { return cols; }
+    int spectrumCols() const { return half; }
+
+    // rows x cols отсчетов -> rows x (cols/2 + 1) частот
+    void execute(const Real* in, ComplexT* out) {
+        if (inverse_) throw logic_error("RealFFT2DPlan: план создан для обратного преобразования");
+        parallelFor(0, rows, threads, [&](int worker, int lo, int hi) {
+            for (int r = lo; r < hi; r++) rowPlans[worker]->execute(in + (size_t)r * cols, out + (size_t)r * half);
+        });
+        transposeBlocked(out, transposed.data(), rows, half, threads);
+        columnPass.execute(transposed.data(), transposed.data());
+        transposeBlocked(transposed.data(), out, half, rows, threads);
+    }
+
+    // rows x (cols/2 + 1) частот -> rows x cols отсчетов (с делением на rows * cols)
+    void execute(const ComplexT* in, Real* out) {
+        if (!inverse_) throw logic_error("RealFFT2DPlan: план создан для прямого преобразования");
+        transposeBlocked(in, transposed.data(), rows, half, threads);
+        columnPass.execute(transposed.data(), transposed.data());
+        transposeBlocked(transposed.data(), spectrum.data(), half, rows, threads);
+        parallelFor(0, rows, threads, [&](int worker, int lo, int hi) {
+            for (int r = lo; r < hi; r++) rowPlans[worker]->execute(spectrum.data() + (size_t)r * half, out + (size_t)r * cols);
+        });
+    }
+
+private:
+    int rows, cols, half;
+    bool inverse_;
+    int threads;
+    BatchFFTPlanT<Real> columnPass;
+    vector<unique_ptr<RealFFTPlanT<Real>>> rowPlans;    // свой план строк у каждого потока
+    AlignedVector<ComplexT> transposed;                 // (cols/2 + 1) x rows
+    AlignedVector<ComplexT> spectrum;                   // обратный план: вход после прохода по столбцам
+};
+
+using RealFFT2DPlan = RealFFT2DPlanT<double>;
+
+vector<Complex> fft2D(const vector<Complex>& image, int rows, int cols, int threads = 1) {
+    vector<Complex> output(image.size());
+    FFT2DPlan(rows, cols, false, threads).execute(image.data(), output.data());
+    return output;
+}
+
+vector<Complex> ifft2D(const vector<Complex>& spectrum, int rows, int cols, int threads = 1) {
+    vector<Complex> output(spectrum.size());
+    FFT2DPlan(rows, cols, true, threads).execute(spectrum.data(), output.data());
+    return output;
+}
+
+vector<Complex> rfft2D(const vector<double>& image, int rows, int cols, int threads = 1) {
+    vector<Complex> output((size_t)rows * (cols / 2 + 1));
+    RealFFT2DPlan(rows, cols, false, threads).execute(image.data(), output.data());
+    return output;
+}
+
+vector<double> irfft2D(const vector<Complex>& half_spectrum, int rows, int cols, int threads = 1) {
+    vector<double> output((size_t)rows * cols);
+    RealFFT2DPlan(rows, cols, true, threads).execute(half_spectrum.data(), output.data());
+    return output;
+}
+
+// filterHighFrequencies по обеим осям для спектра rfft2D: остаются частоты
+// |k1| <= cutoff * rows и k2 <= cutoff * cols
+void filterHighFrequencies2D(vector<Complex>& half_spectrum, int rows, int cols, double cutoff = 0.1) {
+    int half = cols / 2 + 1;
+    int keep_rows = (int)(rows * cutoff), keep_cols = (int)(cols * cutoff);
+    for (int r = 0; r < rows; r++) {
+        bool row_kept = min(r, rows - r) <= keep_rows;
+        for (int c = 0; c < half; c++) {
+            if (!row_kept || c > keep_cols) half_spectrum[(size_t)r * half + c] = 0;
+        }
+    }
+}
+
+// Наименьшее n' >= n вида 2^a 3^b 5^c 7^d: такие длины считаются смешанным основанием
+int nextFastSize(int n) {
+    for (int m = max(n, 1);; m++) {
+        int rest = m;
+        for (int p : { 2, 3, 5, 7 }) {
+            while (rest % p == 0) rest /= p;
+        }
+        if (rest == 1) return m;
+    }
+}
+
+enum class ConvolutionMode { Full, Same };
+
+// Линейная свертка изображения rows x cols с ядром krows x kcols через
+// вещественное 2-D БПФ на сетке (rows + krows - 1) x (cols + kcols - 1),
+// дополненной до nextFastSize. Same - центральная часть размера изображения.
+vector<double> convolve2D(const vector<double>& image, int rows, int cols,
+    const vector<double>& kernel, int krows, int kcols,
+    ConvolutionMode mode = ConvolutionMode::Same, int threads = 1) {
+    int full_rows = rows + krows - 1, full_cols = cols + kcols - 1;
+    int R = nextFastSize(full_rows), C = nextFastSize(full_cols);
+
+    auto padded = [R, C](const vector<double>& source, int source_rows, int source_cols) {
+        vector<double> result((size_t)R * C, 0.0);
+        for (int r = 0; r < source_rows; r++) {
+            copy(source.begin() + (size_t)r * source_cols, source.begin() + (size_t)(r + 1) * source_cols,
+                result.begin() + (size_t)r * C);
+        }
+        return result;
+    };
+
+    RealFFT2DPlan forward(R, C, false, threads);
+    int half = forward.spectrumCols();
+    vector<Complex> image_spectrum((size_t)R * half), kernel_spectrum((size_t)R * half);
+    forward.execute(padded(image, rows, cols).data(), image_spectrum.data());
+    forward.execute(padded(kernel, krows, kcols).data(), kernel_spectrum.data());
+    for (size_t i = 0; i < image_spectrum.size(); i++) image_spectrum[i] *= kernel_spectrum[i];
+
+    vector<double> full((size_t)R * C);
+    RealFFT2DPlan(R, C, true, threads).execute(image_spectrum.data(), full.data());
+
+    int out_rows = mode == ConvolutionMode::Full ? full_rows : rows;
+    int out_cols = mode == ConvolutionMode::Full ? full_cols : cols;
+    int r0 = mode == ConvolutionMode::Full ? 0 : (krows - 1) / 2;
+    int c0 = mode == ConvolutionMode::Full ? 0 : (kcols - 1) / 2;
+    vector<double> output((size_t)out_rows * out_cols);
+    for (int r = 0; r < out_rows; r++) {
+        copy(full.begin() + (size_t)(r + r0) * C + c0, full.begin() + (size_t)(r + r0) * C + c0 + out_cols,
+            output.begin() + (size_t)r * out_cols);
+    }
+    return output;
+}
+
+// Взаимная корреляция: sum image(r + i, c + j) * templ(i, j) - свертка с перевернутым шаблоном.
+// В режиме Full элемент (r, c) соответствует сдвигу (r - trows + 1, c - tcols + 1).
+vector<double> correlate2D(const vector<double>& image, int rows, int cols,
+    const vector<double>& templ, int trows, int tcols,
+    ConvolutionMode mode = ConvolutionMode::Same, int threads = 1) {
+    vector<double> flipped(templ.rbegin(), templ.rend());
+    return convolve2D(image, rows, cols, flipped, trows, tcols, mode, threads);
+}
+
+// Фильтрация изображения: гладкий узор плюс высокочастотная рябь, рябь убирается
+// filterHighFrequencies2D; свертка сверяется с прямой суммой, корреляция ищет шаблон
+void demonstrateImageFilter(double cutoff) {
+    const int rows = 256, cols = 384;
+    vector<double> smooth((size_t)rows * cols), image((size_t)rows * cols);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            double low = cos(2 * PI * (3.0 * r / rows + 5.0 * c / cols)) + 0.5 * sin(2 * PI * 2.0 * c / cols);
+            double ripple = 0.3 * cos(2 * PI * (100.0 * r / rows + 150.0 * c / cols));
+            smooth[(size_t)r * cols + c] = low;
+            image[(size_t)r * cols + c] = low + ripple;
+        }
+    }
+
+    int threads = defaultThreadCount();
+    vector<Complex> spectrum = rfft2D(image, rows, cols, threads);
+    filterHighFrequencies2D(spectrum, rows, cols, cutoff);
+    vector<double> filtered = irfft2D(spectrum, rows, cols, threads);
+    double filter_error = 0.0;
+    for (size_t i = 0; i < filtered.size(); i++) filter_error = max(filter_error, abs(filtered[i] - smooth[i]));
+    cout << "Изображение " << rows << "x" << cols << ", остаток ряби после фильтра: " << filter_error << endl;
+
+    // Свертка с гауссовым ядром 9x9 против прямой суммы
+    const int kr = 9, kc = 9, small_rows = 48, small_cols = 40;
+    vector<double> kernel(kr * kc), small(image.begin(), image.begin() + (size_t)small_rows * small_cols);
+    for (int i = 0; i < kr; i++) {
+        for (int j = 0; j < kc; j++) kernel[i * kc + j] = exp(-((i - 4) * (i - 4) + (j - 4) * (j - 4)) / 8.0);
+    }
+    vector<double> fast = convolve2D(small, small_rows, small_cols, kernel, kr, kc, ConvolutionMode::Full);
+    int full_rows = small_rows + kr - 1, full_cols = small_cols + kc - 1;
+    double conv_error = 0.0;
+    for (int r = 0; r < full_rows; r++) {
+        for (int c = 0; c < full_cols; c++) {
+            double sum = 0.0;
+            for (int i = max(0, r - small_rows + 1); i <= min(r, kr - 1); i++) {
+                for (int j = max(0, c - small_cols + 1); j <= min(c, kc - 1); j++) {
+                    sum += kernel[i * kc + j] * small[(size_t)(r - i) * small_cols + (c - j)];
+                }
+            }
+            conv_error = max(conv_error, abs(fast[(size_t)r * full_cols + c] - sum));
+        }
+    }
+    cout << "Расхождение свертки 2-D БПФ и прямой суммы: " << conv_error << endl;
+
+    // Поиск фрагмента шумовой текстуры корреляцией (шаблон без среднего)
+    const int tr = 16, tc = 16, true_r = 100, true_c = 211;
+    mt19937 rng(7);
+    uniform_real_distribution<double> noise(-1.0, 1.0);
+    vector<double> texture((size_t)rows * cols), templ(tr * tc);
+    for (double& v : texture) v = noise(rng);
+    double mean = 0.0;
+    for (int i = 0; i < tr; i++) {
+        for (int j = 0; j < tc; j++) {
+            templ[i * tc + j] = texture[(size_t)(true_r + i) * cols + true_c + j];
+            mean += templ[i * tc + j] / (tr * tc);
+        }
+    }
+    for (double& t : templ) t -= mean;
+    vector<double> score = correlate2D(texture, rows, cols, templ, tr, tc, ConvolutionMode::Full, threads);
+    size_t best = max_element(score.begin(), score.end()) - score.begin();
+    int full_c = cols + tc - 1;
+    cout << "Фрагмент " << tr << "x" << tc << " найден в (" << (int)(best / full_c) - tr + 1 << ", "
+        << (int)(best % full_c) - tc + 1 << "), вставлен в (" << true_r << ", " << true_c << ")" << endl;
+
+    // Время 2-D БПФ 2048 x 2048
+    const int big = 2048;
+    vector<Complex> picture((size_t)big * big);
+    for (size_t i = 0; i < picture.size(); i++) picture[i] = Complex(sin(0.001 * i), 0.0);
+    for (int t : { 1, threads }) {
+        FFT2DPlan plan(big, big, false, t);
+        auto start = chrono::high_resolution_clock::now();
+        plan.execute(picture.data(), picture.data());
+        auto end = chrono::high_resolution_clock::now();
+        cout << "2-D БПФ " << big << "x" << big << ", потоков " << t << ": "
+            << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " мс" << endl;
+        if (threads == 1) break;
+    }
+}
+
+// ==================== СПЕКТРАЛЬНАЯ ПЛОТНОСТЬ И СПЕКТРОГРАММА ====================
+
+enum class WindowType { Rectangular, Hann, Hamming, Blackman };
+
+// Периодическое окно длины N (знаменатель N, а не N - 1): при сдвиге на N/2
+// окна Ханна в сумме дают константу
+vector<double> makeWindow(WindowType type, int N) {
+    vector<double> window(N);
+    for (int n = 0; n < N; n++) {
+        double x = 2 * PI * n / N;
+        switch (type) {
+        case WindowType::Rectangular: window[n] = 1.0; break;
+        case WindowType::Hann: window[n] = 0.5 - 0.5 * cos(x); break;
+        case WindowType::Hamming: window[n] = 0.54 - 0.46 * cos(x); break;
+        case WindowType::Blackman: window[n] = 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x); break;
+        }
+    }
+    return window;
+}
+
+// Кадр f - отсчеты [f * hop, f * hop + N), неполный хвост записи отбрасывается.
+// Спектр кадра - rfft взвешенного окна; кадры делятся между потоками, у каждого
+// потока свой план и буферы, результат пишется сразу в строку выходного буфера.
+// Масштаб - односторонняя плотность мощности: P_k = c_k |X_k|^2 / (fs * sum w^2),
+// c_k = 2 кроме k = 0 и k = N/2 (четное N), так что sum_k P_k * fs / N = средний квадрат.
+class SpectrogramPlan {
+public:
+    SpectrogramPlan(int frameSize, int hop, WindowType window = WindowType::Hann,
+        double sampleRate = 1.0, int threads = 1)
+        : N(frameSize), hop(hop), bins(frameSize / 2 + 1), threads(max(1, threads)),
+        window(makeWindow(window, frameSize)) {
+        if (frameSize < 2 || hop < 1) {
+            throw invalid_argument("SpectrogramPlan: нужны frameSize >= 2 и hop >= 1");
+        }
+        double energy = 0.0;
+        for (double w : this->window) energy += w * w;
+        scale.assign(bins, 2.0 / (sampleRate * energy));
+        scale[0] /= 2;
+        if (N % 2 == 0) scale[bins - 1] /= 2;
+
+        workspaces.resize(this->threads);
+        for (Workspace& ws : workspaces) {
+            ws.plan.reset(new RealFFTPlan(N));
+            ws.frame.resize(N);
+            ws.spectrum.resize(bins);
+        }
+    }
+
+    int frameSize() const { return N; }
+    int hopSize() const { return hop; }
+    int frequencyCount() const { return bins; }
+    int frameCount(size_t length) const {
+        return length < (size_t)N ? 0 : (int)((length - N) / hop + 1);
+    }
+
+    // power - буфер frameCount(length) x frequencyCount(), строка на кадр
+    void execute(const double* signal, size_t length, double* power) {
+        parallelFor(0, frameCount(length), threads, [&](int worker, int lo, int hi) {
+            Workspace& ws = workspaces[worker];
+            for (int f = lo; f < hi; f++) {
+                transformFrame(ws, signal + (size_t)f * hop);
+                double* row = power + (size_t)f * bins;
+                for (int k = 0; k < bins; k++) row[k] = scale[k] * norm(ws.spectrum[k]);
+            }
+        });
+    }
+
+    // Метод Уэлча: среднее строк спектрограммы без хранения самих строк.
+    // psd - frequencyCount() значений; возвращает число усредненных кадров
+    int welch(const double* signal, size_t length, double* psd) {
+        int frames = frameCount(length);
+        for (Workspace& ws : workspaces) ws.accumulator.assign(bins, 0.0);
+        parallelFor(0, frames, threads, [&](int worker, int lo, int hi) {
+            Workspace& ws = workspaces[worker];
+            for (int f = lo; f < hi; f++) {
+                transformFrame(ws, signal + (size_t)f * hop);
+                for (int k = 0; k < bins; k++) ws.accumulator[k] += norm(ws.spectrum[k]);
+            }
+        });
+
+        for (int k = 0; k < bins; k++) {
+            double sum = 0.0;
+            for (const Workspace& ws : workspaces) sum += ws.accumulator[k];
+            psd[k] = frames > 0 ? scale[k] * sum / frames : 0.0;
+        }
+        return frames;
+    }
+
+private:
+    struct Workspace {
+        unique_ptr<RealFFTPlan> plan;
+        AlignedVector<double> frame;
+        AlignedVector<Complex> spectrum;
+        vector<double> accumulator;     // сумма |X_k|^2 кадров этого потока
+    };
+
+    int N, hop, bins, threads;
+    vector<double> window;
+    vector<double> scale;
+    vector<Workspace> workspaces;
+
+    void transformFrame(Workspace& ws, const double* start) {
+        for (int n = 0; n < N; n++) ws.frame[n] = start[n] * window[n];
+        ws.plan->execute(ws.frame.data(), ws.spectrum.data());
+    }
+};
+
+// Оценка спектральной плотности по Уэлчу: сегменты длины segment со сдвигом hop
+vector<double> welchPSD(const vector<double>& signal, int segment, int hop,
+    WindowType window = WindowType::Hann, double sampleRate = 1.0, int threads = defaultThreadCount()) {
+    SpectrogramPlan plan(segment, hop, window, sampleRate, threads);
+    vector<double> psd(plan.frequencyCount());
+    plan.welch(signal.data(), signal.size(), psd.data());
+    return psd;
+}
+
+// Спектрограмма: frameCount x (frameSize/2 + 1) по строкам
+vector<double> spectrogram(const vector<double>& signal, int frameSize, int hop,
+    WindowType window = WindowType::Hann, double sampleRate = 1.0, int threads = defaultThreadCount()) {
+    SpectrogramPlan plan(frameSize, hop, window, sampleRate, threads);
+    vector<double> power((size_t)plan.frameCount(signal.size()) * plan.frequencyCount());
+    plan.execute(signal.data(), signal.size(), power.data());
+    return power;
+}
+
+// ==================== РАЗРЕЖЕННЫЙ СПЕКТР ====================
+
+// Когда значимых частот мало (k << N), полный спектр не нужен: результат -
+// короткий список (номер частоты, значение), нормировка та же, что у dft/fft.
+
+struct SparseBin {
+    int bin;
+    Complex value;
+};
+
+const int GOERTZEL_GROUP = 8;   // частот за один проход по сигналу
+
+// Алгоритм Герцеля для одной частоты: s_n = x_n + 2 cos(w) s_{n-1} - s_{n-2},
+// X_m = e^{iw} s_{N-1} - s_{N-2}, w = 2 pi m / N. O(N) на частоту, без БПФ.
+Complex goertzel(const vector<Complex>& x, int bin) {
+    int N = x.size();
+    double w = 2 * PI * bin / N;
+    double coef = 2 * cos(w);
+    Complex s1 = 0, s2 = 0;
+    for (int n = 0; n < N; n++) {
+        Complex s0 = x[n] + coef * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    return polar(1.0, w) * s1 - s2;
+}
+
+// Банк фильтров Герцеля для заданного списка частот. Частоты идут группами
+// по GOERTZEL_GROUP, так что сигнал читается один раз на группу. O(N * bins).
+vector<SparseBin> goertzelBank(const vector<Complex>& x, const vector<int>& bins) {
+    int N = x.size();
+    vector<SparseBin> result(bins.size());
+    for (size_t first = 0; first < bins.size(); first += GOERTZEL_GROUP) {
+        int count = min<size_t>(GOERTZEL_GROUP, bins.size() - first);
+        double coef[GOERTZEL_GROUP];
+        Complex s1[GOERTZEL_GROUP], s2[GOERTZEL_GROUP];
+        for (int g = 0; g < count; g++) {
+            coef[g] = 2 * cos(2 * PI * bins[first + g] / N);
+            s1[g] = s2[g] = 0;
+        }
+        for (int n = 0; n < N; n++) {
+            for (int g = 0; g < count; g++) {
+                Complex s0 = x[n] + coef[g] * s1[g] - s2[g];
+                s2[g] = s1[g];
+                s1[g] = s0;
+            }
+        }
+        for (int g = 0; g < count; g++) {
+            int bin = bins[first + g];
+            result[first + g] = { bin, polar(1.0, 2 * PI * bin / N) * s1[g] - s2[g] };
+        }
+    }
+    return result;
+}
+
+long long modularInverse(long long a, long long n) {
+    long long r0 = n, r1 = a % n, t0 = 0, t1 = 1;
+    while (r1 != 0) {
+        long long q = r0 / r1;
+        tie(r0, r1) = make_tuple(r1, r0 - q * r1);
+        tie(t0, t1) = make_tuple(t1, t0 - q * t1);
+    }
+    return t0 < 0 ? t0 + n : t0;
+}
+
+// Наименьший делитель N, не меньший target (0, если такого нет)
+int smallestDivisorAtLeast(int N, int target) {
+    int best = 0;
+    for (int d = 1; (long long)d * d <= N; d++) {
+        if (N % d != 0) continue;
+        for (int divisor : { d, N / d }) {
+            if (divisor >= target && (best == 0 || divisor < best)) best = divisor;
+        }
+    }
+    return best;
+}
+
+// Разреженное БПФ для сигналов, у которых значимы не более k частот (остальные
+// ниже threshold). В каждом раунде частоты перемешиваются случайной перестановкой
+// n -> sigma * n mod N (частота f переходит в sigma * f), затем сигнал
+// прореживается с шагом N / B и сдвигами tau = 0, 1, 2: БПФ длины B складывает
+// в корзину b все частоты, сравнимые с b по модулю B, с множителем e^{2 pi i k tau / N}.
+// Если в корзине одна частота, отношение соседних сдвигов дает ее номер,
+// третий сдвиг проверяет, что частота действительно одна. Найденные частоты
+// вычитаются из корзин следующих раундов. Читается 3B отсчетов за раунд,
+// B ~ 4k - сублинейно по N.
+// Частоты, разность которых делится на B, перестановка не разводит (для N = 2^p
+// это частый случай), поэтому после раунда без новых частот B удваивается.
+// Корзина считается пустой ниже max(threshold, 1e-8 * сильнейшая частота):
+// ниже этого уровня лежат ошибки округления самого сигнала.
+// Если подходящего делителя N нет - полное БПФ.
+vector<SparseBin> sparseFFT(const vector<Complex>& x, int k, double threshold = 1e-6, unsigned seed = 1) {
+    int N = x.size();
+    if (k < 1 || N < 1) return {};
+
+    const int MAX_ROUNDS = 32;
+    const double CONSISTENCY = 1e-6;
+    const double NOISE_FLOOR = 1e-8;
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(1, max(1, N - 1));
+    map<int, Complex> spectrum;
+    bool complete = false;
+    double floor = threshold;
+
+    int B = smallestDivisorAtLeast(N, 4 * k);
+    for (int round = 0; round < MAX_ROUNDS && B != 0 && 3LL * B < N; round++) {
+        int step = N / B;
+        double scale = double(N) / B;
+        FFTPlan& plan = cachedPlan(B, false);
+        vector<Complex> buckets[3] = { vector<Complex>(B), vector<Complex>(B), vector<Complex>(B) };
+
+        long long sigma = pick(rng);
+        while (gcd(sigma, (long long)N) != 1) sigma = pick(rng);
+        long long sigmaInverse = modularInverse(sigma, N);
+
+        for (int tau = 0; tau < 3; tau++) {
+            for (int j = 0; j < B; j++) {
+                buckets[tau][j] = x[(sigma * ((long long)j * step + tau)) % N];
+            }
+            plan.execute(buckets[tau], buckets[tau]);
+        }
+
+        // уже найденные частоты
+        for (const auto& entry : spectrum) {
+            long long kk = sigma * entry.first % N;
+            for (int tau = 0; tau < 3; tau++) {
+                buckets[tau][kk % B] -= entry.second * polar(1.0 / scale, 2 * PI * kk * tau / N);
+            }
+        }
+
+        bool empty = true, progress = false;
+        for (int b = 0; b < B; b++) {
+            Complex value = buckets[0][b] * scale;
+            if (abs(value) <= floor) continue;
+            empty = false;
+
+            Complex ratio = buckets[1][b] / buckets[0][b];
+            if (abs(abs(ratio) - 1) > CONSISTENCY ||
+                abs(buckets[2][b] - buckets[1][b] * ratio) > CONSISTENCY * abs(buckets[1][b])) {
+                continue;   // в корзине несколько частот
+            }
+            long long kk = llround(arg(ratio) * N / (2 * PI));
+            kk = ((kk % N) + N) % N;
+            if (kk % B != b) continue;
+
+            int bin = (int)(kk * sigmaInverse % N);
+            if (!spectrum.count(bin)) progress = true;
+            spectrum[bin] += value;
+            floor = max(floor, NOISE_FLOOR * abs(spectrum[bin]));
+        }
+        if (empty) {
+            complete = true;
+            break;
+        }
+        if (!progress) B = smallestDivisorAtLeast(N, 2 * B);
+    }
+
+    vector<SparseBin> found;
+    if (complete) {
+        for (const auto& entry : spectrum) {
+            if (abs(entry.second) > threshold) found.push_back({ entry.first, entry.second });
+        }
+    }
+    else {
+        // корзины не разделили частоты: полный спектр
+        vector<Complex> X = fft(x);
+        for (int m = 0; m < N; m++) {
+            if (abs(X[m]) > threshold) found.push_back({ m, X[m] });
+        }
+    }
+
+    sort(found.begin(), found.end(), [](const SparseBin& a, const SparseBin& b) {
+        return abs(a.value) > abs(b.value);
+    });
+    if ((int)found.size() > k) found.resize(k);
+    return found;
+}
+
+// ==================== CHIRP-Z (ЛУПА СПЕКТРА) ====================
+
+// X_k = sum_n x_n A^{-n} W^{nk}, k = 0..M-1: M точек на спирали A W^{-k}.
+// По Блюстейну nk = (n^2 + k^2 - (k - n)^2) / 2, и сумма становится сверткой
+// длины L >= N + M - 1, которая считается через БПФ: O((N + M) log(N + M)).
+// A = e^{i theta}, W = e^{-i phi}: равномерная сетка частот theta + k phi (рад/отсчет).
+class ChirpZPlan {
+public:
+    ChirpZPlan(int N, int M, double theta, double phi)
+        : N(N), M(M), L(nextPowerOfTwo(N + M - 1)), forward(L), backward(L, true) {
+        if (N < 1 || M < 1) throw invalid_argument("ChirpZPlan: пустой вход или выход");
+
+        // W^{m^2 / 2} = e^{-i phi m^2 / 2}; m^2 велико, фаза считается в long double
+        auto chirp = [phi](long long m) {
+            long double angle = fmodl((long double)phi * m * m / 2, 2 * (long double)PI);
+            return polar(1.0, -(double)angle);
+        };
+
+        pre.resize(N);
+        for (int n = 0; n < N; n++) pre[n] = polar(1.0, -theta * n) * chirp(n);
+        post.resize(M);
+        for (int k = 0; k < M; k++) post[k] = chirp(k);
+
+        // ядро свертки W^{-m^2 / 2} для m = -(N-1)..(M-1), отрицательные m - в конце
+        kernel.assign(L, Complex(0));
+        for (int m = 0; m < M; m++) kernel[m] = conj(chirp(m));
+        for (int m = 1; m < N; m++) kernel[L - m] = conj(chirp(m));
+        forward.execute(kernel.data(), kernel.data());
+
+        work.resize(L);
+    }
+
+    int inputSize() const { return N; }
+    int outputSize() const { return M; }
+
+    void execute(const Complex* in, Complex* out) {
+        for (int n = 0; n < N; n++) work[n] = in[n] * pre[n];
+        fill(work.begin() + N, work.end(), Complex(0));
+        forward.execute(work.data(), work.data());
+        for (int j = 0; j < L; j++) work[j] *= kernel[j];
+        backward.execute(work.data(), work.data());
+        for (int k = 0; k < M; k++) out[k] = work[k] * post[k];
+    }
+
+private:
+    int N, M, L;
+    FFTPlan forward, backward;
+    AlignedVector<Complex> pre, post, kernel, work;
+};
+
+vector<Complex> czt(const vector<Complex>& input, int M, double theta, double phi) {
+    vector<Complex> output(M);
+    ChirpZPlan plan(input.size(), M, theta, phi);
+    plan.execute(input.data(), output.data());
+    return output;
+}
+
+// Спектр в M равноотстоящих точках частот [f0, f1], частоты в единицах номера
+// DFT (m = f дает dft(input)[m]); дробные f - между отсчетами DFT
+vector<Complex> zoomSpectrum(const vector<Complex>& input, double f0, double f1, int M) {
+    int N = input.size();
+    double step = M > 1 ? (f1 - f0) / (M - 1) : 0;
+    return czt(input, M, 2 * PI * f0 / N, 2 * PI * step / N);
+}
+
+// ==================== DCT И MDCT ====================
+
+// DCT-II:  X_k = sum_n x_n cos(pi k (2n + 1) / 2N).
+// DCT-III здесь - обратное к нему: x_n = (X_0 / 2 + sum_{k>=1} X_k cos(pi k (2n + 1) / 2N)) * 2 / N.
+// Оба через одно вещественное БПФ длины N (Макхол): четные отсчеты в прямом
+// порядке, нечетные - в обратном, затем поворот X_k = Re(e^{-i pi k / 2N} V_k).
+class DCTPlan {
+public:
+    explicit DCTPlan(int N) : N(N), forwardPlan(N), inversePlan(N, true) {
+        if (N < 1) throw invalid_argument("DCTPlan: пустой блок");
+        rotation.resize(N / 2 + 1);
+        for (int k = 0; k <= N / 2; k++) rotation[k] = polar(1.0, -PI * k / (2 * N));
+        permuted.resize(N);
+        spectrum.resize(N / 2 + 1);
+    }
+
+    int size() const { return N; }
+
+    // DCT-II, in и out не должны совпадать
+    void forward(const double* in, double* out) {
+        for (int n = 0; n < (N + 1) / 2; n++) permuted[n] = in[2 * n];
+        for (int n = 0; n < N / 2; n++) permuted[N - 1 - n] = in[2 * n + 1];
+        forwardPlan.execute(permuted.data(), spectrum.data());
+
+        // V_{N-k} = conj(V_k): вторая половина из первой
+        for (int k = 0; k <= N / 2; k++) {
+            Complex v = rotation[k] * spectrum[k];
+            out[k] = v.real();
+            if (k > 0 && k < N - k) out[N - k] = -v.imag();
+        }
+    }
+
+    // DCT-III (обратное к forward), in и out не должны совпадать
+    void inverse(const double* in, double* out) {
+        // V_k = e^{i pi k / 2N} (X_k - i X_{N-k}), X_N = 0
+        for (int k = 0; k <= N / 2; k++) {
+            double opposite = k == 0 ? 0.0 : in[N - k];
+            spectrum[k] = conj(rotation[k]) * Complex(in[k], -opposite);
+        }
+        inversePlan.execute(spectrum.data(), permuted.data());
+        for (int n = 0; n < (N + 1) / 2; n++) out[2 * n] = permuted[n];
+        for (int n = 0; n < N / 2; n++) out[2 * n + 1] = permuted[N - 1 - n];
+    }
+
+private:
+    int N;
+    RealFFTPlan forwardPlan, inversePlan;
+    vector<Complex> rotation;   // e^{-i pi k / 2N}
+    vector<double> permuted;
+    vector<Complex> spectrum;
+};
+
+vector<double> dct2(const vector<double>& input) {
+    vector<double> output(input.size());
+    DCTPlan(input.size()).forward(input.data(), output.data());
+    return output;
+}
+
+vector<double> dct3(const vector<double>& input) {
+    vector<double> output(input.size());
+    DCTPlan(input.size()).inverse(input.data(), output.data());
+    return output;
+}
+
+// MDCT с окном синуса: кадр из 2N отсчетов -> N коэффициентов,
+// X_k = sum_{n<2N} w_n x_n cos(pi / N (n + 1/2 + N/2)(k + 1/2)).
+// Кадры идут с шагом N; w_n^2 + w_{n+N}^2 = 1, поэтому наложения (TDAC)
+// взаимно уничтожаются и сумма обратных преобразований дает исходный сигнал.
+// Кадр сворачивается в N отсчетов, дальше DCT-IV через комплексное БПФ длины N/2.
+class MDCTPlan {
+public:
+    explicit MDCTPlan(int N) : N(N), fftPlan(max(1, N / 2)) {
+        if (N < 2 || N % 2 != 0) throw invalid_argument("MDCTPlan: N должно быть четным");
+        window.resize(2 * N);
+        for (int n = 0; n < 2 * N; n++) window[n] = sin(PI * (n + 0.5) / (2 * N));
+        int H = N / 2;
+        preTwiddles.resize(H);
+        postTwiddles.resize(H);
+        for (int n = 0; n < H; n++) {
+            preTwiddles[n] = polar(1.0, -PI * n / N);
+            postTwiddles[n] = polar(1.0, -PI * (4 * n + 1) / (4.0 * N));
+        }
+        folded.resize(N);
+        work.resize(H);
+    }
+
+    int size() const { return N; }
+
+    // 2N отсчетов -> N коэффициентов
+    void forward(const double* in, double* out) {
+        int H = N / 2;
+        // свертка: отсчеты n < N/2 и n >= 3N/2 переходят в f, средние - с минусом в обратном порядке
+        for (int m = 0; m < H; m++) {
+            folded[m] = -window[3 * H - 1 - m] * in[3 * H - 1 - m] - window[m + 3 * H] * in[m + 3 * H];
+            folded[m + H] = window[m] * in[m] - window[N - 1 - m] * in[N - 1 - m];
+        }
+        dct4(folded.data(), out);
+    }
+
+    // N коэффициентов -> 2N отсчетов y_n = (2 / N) w_n sum_k X_k cos(...);
+    // соседние кадры нужно сложить с шагом N
+    void inverse(const double* in, double* out) {
+        int H = N / 2;
+        dct4(in, folded.data());
+        double scale = 2.0 / N;
+        for (int n = 0; n < H; n++) out[n] = folded[n + H];
+        for (int n = H; n < 3 * H; n++) out[n] = -folded[3 * H - 1 - n];
+        for (int n = 3 * H; n < 2 * N; n++) out[n] = -folded[n - 3 * H];
+        for (int n = 0; n < 2 * N; n++) out[n] *= window[n] * scale;
+    }
+
+private:
+    int N;
+    FFTPlan fftPlan;
+    vector<double> window;
+    vector<Complex> preTwiddles;    // e^{-i pi n / N}
+    vector<Complex> postTwiddles;   // e^{-i pi (4k + 1) / 4N}
+    vector<double> folded;
+    vector<Complex> work;
+
+    // DCT-IV: Y_k = sum_n u_n cos(pi / N (n + 1/2)(k + 1/2)), u и y не должны совпадать.
+    // z_m = u_{2m} + i u_{N-1-2m}: W_p = e^{-i pi (p + 1/4) / N} FFT_{N/2}(z_m e^{-i pi m / N})_p,
+    // Y_{2p} = Re W_p, Y_{N-1-2p} = -Im W_p
+    void dct4(const double* u, double* y) {
+        int H = N / 2;
+        for (int n = 0; n < H; n++) work[n] = Complex(u[2 * n], u[N - 1 - 2 * n]) * preTwiddles[n];
+        fftPlan.execute(work.data(), work.data());
+        for (int k = 0; k < H; k++) {
+            Complex v = work[k] * postTwiddles[k];
+            y[2 * k] = v.real();
+            y[N - 1 - 2 * k] = -v.imag();
+        }
+    }
+};
+
+// Блочные преобразования кадрированного сигнала. Коэффициенты всех блоков лежат
+// подряд: блок b занимает [b * N, (b + 1) * N).
+
+// DCT-II по непересекающимся блокам длины N, последний дополняется нулями
+vector<double> blockDCT(const vector<double>& signal, int N) {
+    int blocks = (signal.size() + N - 1) / N;
+    vector<double> coefficients((size_t)blocks * N, 0.0);
+    vector<double> block(N);
+    DCTPlan plan(N);
+    for (int b = 0; b < blocks; b++) {
+        fill(block.begin(), block.end(), 0.0);
+        size_t first = (size_t)b * N;
+        copy(signal.begin() + first, signal.begin() + min(signal.size(), first + N), block.begin());
+        plan.forward(block.data(), coefficients.data() + first);
+    }
+    return coefficients;
+}
+
+vector<double> blockIDCT(const vector<double>& coefficients, int N, size_t length) {
+    vector<double> signal(coefficients.size());
+    DCTPlan plan(N);
+    for (size_t first = 0; first < coefficients.size(); first += N) {
+        plan.inverse(coefficients.data() + first, signal.data() + first);
+    }
+    signal.resize(length);
+    return signal;
+}
+
+// MDCT кадрами 2N с шагом N. Сигнал мысленно дополняется N нулями слева и
+// справа, так что каждый отсчет накрыт двумя кадрами: ceil(length / N) + 1 кадров.
+vector<double> blockMDCT(const vector<double>& signal, int N) {
+    int frames = (signal.size() + N - 1) / N + 1;
+    vector<double> padded((size_t)(frames + 1) * N, 0.0);
+    copy(signal.begin(), signal.end(), padded.begin() + N);
+
+    vector<double> coefficients((size_t)frames * N);
+    MDCTPlan plan(N);
+    for (int f = 0; f < frames; f++) {
+        plan.forward(padded.data() + (size_t)f * N, coefficients.data() + (size_t)f * N);
+    }
+    return coefficients;
+}
+
+vector<double> blockIMDCT(const vector<double>& coefficients, int N, size_t length) {
+    int frames = coefficients.size() / N;
+    vector<double> padded((size_t)(frames + 1) * N, 0.0);
+    vector<double> frame(2 * N);
+    MDCTPlan plan(N);
+    for (int f = 0; f < frames; f++) {
+        plan.inverse(coefficients.data() + (size_t)f * N, frame.data());
+        double* target = padded.data() + (size_t)f * N;
+        for (int n = 0; n < 2 * N; n++) target[n] += frame[n];
+    }
+    return vector<double>(padded.begin() + N, padded.begin() + N + length);
+}
+
+// Простое сжатие: в каждом блоке остаются коэффициенты не меньше
+// ratio * (наибольший по модулю коэффициент блока), остальные обнуляются
+int quantizeBlocks(vector<double>& coefficients, int N, double ratio) {
+    int kept = 0;
+    for (size_t first = 0; first < coefficients.size(); first += N) {
+        double largest = 0;
+        for (int k = 0; k < N; k++) largest = max(largest, abs(coefficients[first + k]));
+        for (int k = 0; k < N; k++) {
+            if (abs(coefficients[first + k]) < ratio * largest) coefficients[first + k] = 0;
+            else kept++;
+        }
+    }
+    return kept;
+}
+
+// Отфильтрованный сигнал через DCT и MDCT: точность восстановления без сжатия
+// и ошибка при отбрасывании малых коэффициентов
+void compressSignal(const vector<double>& signal, int N, double ratio) {
+    for (int method = 0; method < 2; method++) {
+        vector<double> coefficients = method == 0 ? blockDCT(signal, N) : blockMDCT(signal, N);
+        vector<double> exact = method == 0 ? blockIDCT(coefficients, N, signal.size())
+            : blockIMDCT(coefficients, N, signal.size());
+        int kept = quantizeBlocks(coefficients, N, ratio);
+        vector<double> restored = method == 0 ? blockIDCT(coefficients, N, signal.size())
+            : blockIMDCT(coefficients, N, signal.size());
+
+        double exact_error = 0, error = 0, energy = 0;
+        for (size_t n = 0; n < signal.size(); n++) {
+            exact_error = max(exact_error, abs(exact[n] - signal[n]));
+            error += (restored[n] - signal[n]) * (restored[n] - signal[n]);
+            energy += signal[n] * signal[n];
+        }
+        cout << (method == 0 ? "DCT-II, блоки " : "MDCT, кадры 2x") << N
+            << ": восстановление " << exact_error << ", оставлено " << kept << " из "
+            << coefficients.size() << " коэффициентов, отн. СКО " << sqrt(error / energy) << endl;
+    }
+}
+
+// ==================== ПУНКТ 2: ГЕНЕРАЦИЯ СИГНАЛОВ ====================
+
+struct SignalParams {
+    int N;
+    double A, B;
+    double omega1, omega2;
+    double phi;
+};
+
+vector<Complex> generateSignal1(const SignalParams& params) {
+    vector<Complex> signal(params.N);
+    for (int j = 0; j < params.N; j++) {
+        double value = params.A * cos(2 * PI * params.omega1 * j / params.N + params.phi) +
+            params.B * cos(2 * PI * params.omega2 * j / params.N);
+        signal[j] = value;
+    }
+    return signal;
+}
+
+vector<Complex> generateSignal2(const SignalParams& params) {
+    vector<Complex> signal(params.N, 0);
+    for (int j = params.N / 4; j <= params.N / 2; j++) {
+        signal[j] = params.A + params.B * cos(2 * PI * params.omega2 * j / params.N);
+    }
+    for (int j = 3 * params.N / 4; j < params.N; j++) {
+        signal[j] = params.A + params.B * cos(2 * PI * params.omega2 * j / params.N);
+    }
+    return signal;
+}
+
+// ==================== ПУНКТ 3: АНАЛИЗ И СРАВНЕНИЕ ====================
+
+struct TimingResults {
+    long long dft_time;
+    long long fft_time;
+    long long rfft_time;
+};
+
+struct AnalysisResults {
+    vector<Complex> dft_result;
+    vector<Complex> fft_result;
+    vector<Complex> rfft_result;   // частоты 0..N/2
+    TimingResults timing;
+};
+
+void printResultsTable(const vector<Complex>& signal, const vector<Complex>& dft_result) {
+    cout << fixed << setprecision(6);
+    cout << setw(4) << "m" << setw(12) << "Re z" << setw(15) << "Re z_hat"
+        << setw(15) << "Im z_hat" << setw(15) << "Amplitude" << setw(12) << "Phase" << endl;
+    cout << string(75, '-') << endl;
+
+    int N = signal.size();
+    double amplitude_limit = 1e-6;
+    double phase_limit = 1e-6;
+    int count = 0;
+
+    for (int m = 0; m < N; m++) {
+        double amplitude = abs(dft_result[m]);
+        double phase = arg(dft_result[m]);
+
+        bool significant_amplitude = (amplitude > amplitude_limit);
+        bool significant_phase = (abs(phase) > phase_limit);
+
+        if (significant_amplitude) { // вариант без  '|| significant_phase'
+            cout << setw(4) << m << setw(12) << signal[m].real()
+                << setw(15) << dft_result[m].real()
+                << setw(15) << dft_result[m].imag()
+                << setw(15) << amplitude
+                << setw(12) << phase << endl;
+            count++;
+        }
+    }
+
+    cout << defaultfloat;
+    cout << "Всего выведено компонент: " << count << " из " << N << endl;
+}
+
+void printSparseSpectrum(const vector<SparseBin>& bins) {
+    cout << fixed << setprecision(6);
+    cout << setw(10) << "m" << setw(15) << "Re z_hat" << setw(15) << "Im z_hat" << setw(15) << "Amplitude" << endl;
+    for (const SparseBin& entry : bins) {
+        cout << setw(10) << entry.bin << setw(15) << entry.value.real() << setw(15) << entry.value.imag()
+            << setw(15) << abs(entry.value) << endl;
+    }
+    cout << defaultfloat;
+}
+
+// Разреженный спектр сигнала: sparse FFT и банк Герцеля на найденных частотах
+// сверяются с DFT, затем то же для длинной записи (N = 2^22) против полного БПФ
+void analyzeSparseSpectrum(const SignalParams& params, const vector<Complex>& signal,
+    const vector<Complex>& dft_result) {
+    int k = 4;  // два косинуса - четыре комплексные частоты
+    vector<SparseBin> sparse = sparseFFT(signal, k);
+    printSparseSpectrum(sparse);
+
+    vector<int> bins;
+    double sparse_error = 0;
+    for (const SparseBin& entry : sparse) {
+        bins.push_back(entry.bin);
+        sparse_error = max(sparse_error, abs(entry.value - dft_result[entry.bin]));
+    }
+    double goertzel_error = 0;
+    for (const SparseBin& entry : goertzelBank(signal, bins)) {
+        goertzel_error = max(goertzel_error, abs(entry.value - dft_result[entry.bin]));
+    }
+    cout << "Расхождение с DFT: sparse FFT " << sparse_error << ", банк Герцеля " << goertzel_error << endl;
+
+    SignalParams long_params = params;
+    long_params.N = 1 << 22;
+    long_params.omega2 = params.omega2 * (long_params.N / params.N) + 3;
+    vector<Complex> long_signal = generateSignal1(long_params);
+
+    auto start_sparse = high_resolution_clock::now();
+    vector<SparseBin> long_sparse = sparseFFT(long_signal, k);
+    auto end_sparse = high_resolution_clock::now();
+    // Сигнал дальше не нужен: спектр считается на месте, без второго буфера на 2^22 точек
+    fftInPlace(long_signal);
+    const vector<Complex>& long_spectrum = long_signal;
+    auto end_fft = high_resolution_clock::now();
+
+    double long_error = 0;
+    for (const SparseBin& entry : long_sparse) {
+        long_error = max(long_error, abs(entry.value - long_spectrum[entry.bin]) / abs(long_spectrum[entry.bin]));
+    }
+    cout << "N = " << long_params.N << ": sparse FFT " << duration_cast<microseconds>(end_sparse - start_sparse).count()
+        << " мкс, FFT " << duration_cast<microseconds>(end_fft - end_sparse).count()
+        << " мкс, найдено частот " << long_sparse.size() << ", отн. расхождение " << long_error << endl;
+}
+
+// Узкая полоса вокруг omega2 с шагом 0.01 частоты DFT: chirp-Z против DFT
+// в целых точках и против БПФ, дополненного нулями до той же разрешающей способности
+void analyzeZoomSpectrum(const SignalParams& params, const vector<Complex>& signal,
+    const vector<Complex>& dft_result) {
+    double f0 = params.omega2 - 1, f1 = params.omega2 + 1;
+    int M = 201;
+    int refine = 100;
+
+    auto start_czt = high_resolution_clock::now();
+    vector<Complex> zoom = zoomSpectrum(signal, f0, f1, M);
+    auto end_czt = high_resolution_clock::now();
+
+    vector<Complex> padded_spectrum(signal.size() * refine, 0);
+    copy(signal.begin(), signal.end(), padded_spectrum.begin());
+    fftInPlace(padded_spectrum);
+    auto end_padded = high_resolution_clock::now();
+
+    int peak = 0;
+    double dft_error = 0, padded_error = 0;
+    for (int k = 0; k < M; k++) {
+        if (abs(zoom[k]) > abs(zoom[peak])) peak = k;
+        padded_error = max(padded_error, abs(zoom[k] - padded_spectrum[(int)(f0 * refine) + k]));
+        if (k % refine == 0) {
+            dft_error = max(dft_error, abs(zoom[k] - dft_result[(int)f0 + k / refine]));
+        }
+    }
+    double step = (f1 - f0) / (M - 1);
+    cout << "Chirp-Z: " << M << " точек в [" << f0 << ", " << f1 << "], шаг " << step
+        << ", максимум при m = " << f0 + peak * step << " (|z_hat| = " << abs(zoom[peak]) << ")" << endl;
+    cout << "Расхождение с DFT в целых точках: " << dft_error
+        << ", с БПФ длины " << padded_spectrum.size() << ": " << padded_error << endl;
+    cout << "Время: chirp-Z " << duration_cast<microseconds>(end_czt - start_czt).count()
+        << " мкс, БПФ с дополнением нулями " << duration_cast<microseconds>(end_padded - end_czt).count()
+        << " мкс" << endl;
+}
+
+// Длинная запись (тот же сигнал на 4096 периодах N плюс белый шум): плотность
+// мощности по Уэлчу и спектрограмма против цикла вызовов fft по кадрам
+void analyzeLongRecording(const SignalParams& params) {
+    const int periods = 4096, segment = 1024, hop = segment / 2;
+    const double noise_sigma = 0.5;
+    size_t length = (size_t)params.N * periods;
+    vector<double> recording(length);
+    mt19937 rng(2025);
+    normal_distribution<double> noise(0.0, noise_sigma);
+    for (size_t j = 0; j < length; j++) {
+        recording[j] = params.A * cos(2 * PI * params.omega1 * j / params.N + params.phi) +
+            params.B * cos(2 * PI * params.omega2 * j / params.N) + noise(rng);
+    }
+
+    int threads = defaultThreadCount();
+    SpectrogramPlan plan(segment, hop, WindowType::Hann, 1.0, threads);
+    vector<double> psd(plan.frequencyCount());
+    vector<double> power((size_t)plan.frameCount(length) * plan.frequencyCount());
+
+    auto start_welch = high_resolution_clock::now();
+    int frames = plan.welch(recording.data(), length, psd.data());
+    auto end_welch = high_resolution_clock::now();
+    plan.execute(recording.data(), length, power.data());
+    auto end_spectrogram = high_resolution_clock::now();
+
+    // То же через отдельные вызовы fft: комплексный кадр и спектр в новых векторах
+    vector<double> window = makeWindow(WindowType::Hann, segment);
+    vector<double> naive(plan.frequencyCount(), 0.0);
+    for (int f = 0; f < frames; f++) {
+        vector<Complex> frame(recording.begin() + (size_t)f * hop, recording.begin() + (size_t)f * hop + segment);
+        for (int n = 0; n < segment; n++) frame[n] *= window[n];
+        vector<Complex> spectrum = fft(frame);
+        for (int k = 0; k < plan.frequencyCount(); k++) naive[k] += norm(spectrum[k]);
+    }
+    auto end_naive = high_resolution_clock::now();
+
+    // Частоты в единицах omega (периодов на N отсчетов)
+    double to_omega = (double)params.N / segment;
+    int peak1 = 1, peak2 = -1;
+    for (int k = 1; k < plan.frequencyCount(); k++) {
+        if (psd[k] > psd[peak1]) peak1 = k;
+    }
+    for (int k = 1; k < plan.frequencyCount(); k++) {
+        if (abs(k - peak1) > 4 && (peak2 < 0 || psd[k] > psd[peak2])) peak2 = k;
+    }
+    vector<double> sorted(psd.begin() + 1, psd.end() - 1);
+    nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    double total_power = 0.0;
+    for (double p : psd) total_power += p / segment;
+
+    cout << "Запись " << length << " отсчетов, " << frames << " сегментов по " << segment
+        << " (сдвиг " << hop << "), потоков " << threads << endl;
+    cout << "Пики плотности: omega = " << peak1 * to_omega << " и " << peak2 * to_omega << endl;
+    cout << "Уровень шума (медиана): " << sorted[sorted.size() / 2] << ", теория 2*sigma^2 = "
+        << 2 * noise_sigma * noise_sigma << endl;
+    cout << "Мощность по плотности: " << total_power << ", теория A^2/2 + B^2/2 + sigma^2 = "
+        << (params.A * params.A + params.B * params.B) / 2 + noise_sigma * noise_sigma << endl;
+    cout << "Время: Уэлч " << duration_cast<milliseconds>(end_welch - start_welch).count()
+        << " мс, спектрограмма " << plan.frameCount(length) << "x" << plan.frequencyCount() << " "
+        << duration_cast<milliseconds>(end_spectrogram - end_welch).count()
+        << " мс, цикл вызовов fft " << duration_cast<milliseconds>(end_naive - end_spectrogram).count() << " мс" << endl;
+}
+
+AnalysisResults analyzeSignal(const vector<Complex>& signal) {
+    AnalysisResults results;
+
+    auto start_dft = high_resolution_clock::now();
+    results.dft_result = dft(signal);
+    auto end_dft = high_resolution_clock::now();
+
+    auto start_fft = high_resolution_clock::now();
+    results.fft_result = fft(signal);
+    auto end_fft = high_resolution_clock::now();
+
+    // Сигнал вещественный: достаточно половины спектра
+    vector<double> real_signal = realPart(signal);
+    auto start_rfft = high_resolution_clock::now();
+    results.rfft_result = rfft(real_signal);
+    auto end_rfft = high_resolution_clock::now();
+
+    results.timing.dft_time = duration_cast<microseconds>(end_dft - start_dft).count();
+    results.timing.fft_time = duration_cast<microseconds>(end_fft - start_fft).count();
+    results.timing.rfft_time = duration_cast<microseconds>(end_rfft - start_rfft).count();
+
+    return results;
+}
+
+// ==================== ПУНКТ 4: ФИЛЬТРАЦИЯ ШУМА ====================
+
+// cutoff - доля сохраняемых частот (по умолчанию 10%)
+vector<Complex> filterHighFrequencies(const vector<Complex>& dft_result, double cutoff = 0.1) {
+    int N = dft_result.size();
+    vector<Complex> filtered = dft_result;
+
+    // Оставляем только низкие частоты (первые и последние cutoff * N)
+    int keep_count = (int)(N * cutoff);
+
+    cout << "Простая фильтрация:" << endl;
+    cout << "Сохраняем частоты: m = 0..." << keep_count << " и " << N - keep_count << "...N-1" << endl;
+    cout << "Обнуляем все остальные частоты" << endl;
+
+    int removed_count = 0;
+    for (int k = keep_count + 1; k < N - keep_count; k++) {
+        if (abs(filtered[k]) > 1e-6) {
+            removed_count++;
+        }
+        filtered[k] = 0;
+    }
+
+    cout << "Удалено компонент с ненулевой амплитудой: " << removed_count << endl;
+    return filtered;
+}
+
+// То же для половины спектра вещественного сигнала длины N (частоты 0..N/2):
+// обнуляются m = keep_count+1..N/2, зеркальные частоты подразумеваются
+vector<Complex> filterHighFrequencies(const vector<Complex>& half_spectrum, int N, double cutoff = 0.1) {
+    vector<Complex> filtered = half_spectrum;
+    int keep_count = (int)(N * cutoff);
+    for (int k = keep_count + 1; k <= N / 2; k++) {
+        filtered[k] = 0;
+    }
+    return filtered;
+}
+
+// ==================== ПОТОКОВАЯ ФИЛЬТРАЦИЯ ====================
+
+// Для непрерывных потоков: отсчеты приходят порциями любой длины, память O(кадра),
+// задержка ограничена длиной кадра, а не длиной записи.
+
+enum class StreamMethod { OverlapAdd, OverlapSave };
+
+// КИХ-фильтр из желаемой АЧХ gain(f), f - доля частоты дискретизации 0..0.5:
+// частотная выборка на сетке из nextPowerOfTwo(4 * taps) точек, обратное
+// преобразование, окно Ханна на taps отсчетах (taps нечетно: линейная фаза,
+// задержка taps / 2)
+vector<double> frequencySampledFIR(const function<double(double)>& gain, int taps) {
+    if (taps < 1 || taps % 2 == 0) {
+        throw invalid_argument("frequencySampledFIR: число отсчетов должно быть нечетным");
+    }
+    int N = nextPowerOfTwo(4 * taps);
+    int center = taps / 2;
+    vector<Complex> half(N / 2 + 1);
+    for (int k = 0; k <= N / 2; k++) {
+        // сдвиг на center отсчетов делает отклик причинным
+        half[k] = gain(double(k) / N) * polar(1.0, -2 * PI * k * center / N);
+    }
+    vector<double> impulse = irfft(half, N);
+
+    vector<double> h(taps);
+    for (int n = 0; n < taps; n++) {
+        double window = taps == 1 ? 1.0 : 0.5 - 0.5 * cos(2 * PI * n / (taps - 1));
+        h[n] = impulse[n] * window;
+    }
+    return h;
+}
+
+// Свертка потока с КИХ-фильтром h (M отсчетов) блоками по L отсчетов через БПФ
+// длины N = L + M - 1 (степень двойки, не меньше 2M).
+// OverlapSave: БПФ последних N входных отсчетов, первые M - 1 отсчетов результата
+// испорчены циклическим переносом и отбрасываются.
+// OverlapAdd: БПФ блока, дополненного нулями, хвост из M - 1 отсчетов
+// прибавляется к следующему блоку.
+// Выход - та же линейная свертка y = h * x без сдвига, выдается по L отсчетов,
+// поэтому задержка не больше L - 1 отсчета.
+class StreamingConvolver {
+public:
+    StreamingConvolver(const vector<double>& h, StreamMethod method = StreamMethod::OverlapSave, int fftSize = 0)
+        : method(method), M(h.size()),
+        N(fftSize > 0 ? fftSize : nextPowerOfTwo(2 * max<int>(h.size(), 1))),
+        L(N - M + 1), forward(N), backward(N, true) {
+        if (M < 1 || L < 1) {
+            throw invalid_argument("StreamingConvolver: длина БПФ меньше длины фильтра");
+        }
+        vector<double> padded(N, 0.0);
+        copy(h.begin(), h.end(), padded.begin());
+        response.resize(N / 2 + 1);
+        forward.execute(padded.data(), response.data());
+
+        frame.resize(N);
+        spectrum.resize(N / 2 + 1);
+        block.resize(N);
+        tail.resize(M - 1);
+        reset();
+    }
+
+    int blockSize() const { return L; }
+    int fftSize() const { return N; }
+    int filterLength() const { return M; }
+    // Наибольшая задержка между приходом отсчета и выдачей его результата
+    int latency() const { return L - 1; }
+
+    // Дописывает в out все отсчеты, которые стали готовы
+    void process(const double* in, int count, vector<double>& out) {
+        while (count > 0) {
+            int take = min(count, L - filled);
+            copy(in, in + take, block.begin() + start() + filled);
+            filled += take;
+            received += take;
+            in += take;
+            count -= take;
+            if (filled == L) runBlock(out, L);
+        }
+    }
+
+    vector<double> process(const vector<double>& chunk) {
+        vector<double> out;
+        process(chunk.data(), chunk.size(), out);
+        return out;
+    }
+
+    // Конец потока: досчитывает неполный блок и хвост свертки (M - 1 отсчетов),
+    // после чего фильтр готов к новому потоку
+    vector<double> flush() {
+        vector<double> out;
+        long long total = received + M - 1;
+        while (emitted < total) {
+            fill(block.begin() + start() + filled, block.begin() + start() + L, 0.0);
+            filled = L;
+            runBlock(out, (int)min<long long>(L, total - emitted));
+        }
+        reset();
+        return out;
+    }
+
+    void reset() {
+        fill(block.begin(), block.end(), 0.0);
+        fill(tail.begin(), tail.end(), 0.0);
+        filled = 0;
+        received = emitted = 0;
+    }
+
+private:
+    StreamMethod method;
+    int M, N, L;
+    RealFFTPlan forward, backward;
+    vector<Complex> response;       // H_k, k = 0..N/2
+    vector<Complex> spectrum;
+    vector<double> frame;
+    vector<double> block;           // OverlapSave: M - 1 старых отсчетов + L новых; OverlapAdd: L новых и нули
+    vector<double> tail;            // OverlapAdd: хвост предыдущего блока
+    int filled;
+    long long received, emitted;
+
+    int start() const { return method == StreamMethod::OverlapSave ? M - 1 : 0; }
+
+    void runBlock(vector<double>& out, int keep) {
+        forward.execute(block.data(), spectrum.data());
+        for (int k = 0; k <= N / 2; k++) spectrum[k] *= response[k];
+        backward.execute(spectrum.data(), frame.data());
+
+        if (method == StreamMethod::OverlapSave) {
+            out.insert(out.end(), frame.begin() + M - 1, frame.begin() + M - 1 + keep);
+            // последние M - 1 входных отсчетов остаются в начале буфера
+            copy(block.begin() + L, block.end(), block.begin());
+        }
+        else {
+            for (int n = 0; n < M - 1; n++) frame[n] += tail[n];
+            out.insert(out.end(), frame.begin(), frame.begin() + keep);
+            copy(frame.begin() + L, frame.end(), tail.begin());
+        }
+        emitted += keep;
+        filled = 0;
+    }
+};
+
+// Кратковременное преобразование Фурье с окном sqrt(Ханна), кадр frameSize,
+// шаг hop (frameSize кратно hop). Каждый кадр: окно, RFFT, modify(половина спектра),
+// IRFFT, окно, взвешенное сложение с перекрытием. Без изменения спектра выход
+// совпадает со входом, задержанным на latency() = frameSize - hop отсчетов.
+class StreamingSTFT {
+public:
+    using SpectrumCallback = function<void(vector<Complex>& half_spectrum)>;
 
-// ==================== ПУНКТ 1: БАЗОВЫЕ ПРЕОБРАЗОВАНИЯ ====================
+    StreamingSTFT(int frameSize, int hop, SpectrumCallback modify)
+        : N(frameSize), hop(hop), modify(move(modify)), forward(frameSize), backward(frameSize, true) {
+        if (N < 2 || hop < 1 || hop > N || N % hop != 0) {
+            throw invalid_argument("StreamingSTFT: длина кадра должна быть кратна шагу");
+        }
+        window.resize(N);
+        for (int n = 0; n < N; n++) {
+            window[n] = sqrt(0.5 - 0.5 * cos(2 * PI * n / N));
+        }
+        // sum_k w^2[n + k * hop] - нормировка синтеза, годится для любого окна
+        synthesis.resize(N);
+        for (int n = 0; n < N; n++) {
+            double norm = 0;
+            for (int m = n % hop; m < N; m += hop) norm += window[m] * window[m];
+            synthesis[n] = window[n] / norm;
+        }
 
-vector<Complex> dft(const vector<Complex>& input) {
-    int N = input.size();
-    vector<Complex> output(N, 0);
+        input.resize(N);
+        frame.resize(N);
+        accumulator.resize(N);
+        spectrum.resize(N / 2 + 1);
+        reset();
+    }
 
-    for (int m = 0; m < N; m++) {
-        for (int n = 0; n < N; n++) {
-            double angle = -2 * PI * m * n / N;
-            output[m] += input[n] * exp(Complex(0, angle));
+    int frameSize() const { return N; }
+    int hopSize() const { return hop; }
+    int latency() const { return N - hop; }
+
+    // На каждые hop входных отсчетов дописывает в out hop выходных
+    void process(const double* in, int count, vector<double>& out) {
+        while (count > 0) {
+            int take = min(count, hop - pending);
+            copy(in, in + take, input.begin() + (N - hop) + pending);
+            pending += take;
+            in += take;
+            count -= take;
+            if (pending == hop) runFrame(out);
         }
     }
-    return output;
-}
 
-vector<Complex> idft(const vector<Complex>& input) {
-    int N = input.size();
-    vector<Complex> output(N, 0);
+    vector<double> process(const vector<double>& chunk) {
+        vector<double> out;
+        process(chunk.data(), chunk.size(), out);
+        return out;
+    }
 
-    for (int n = 0; n < N; n++) {
-        for (int m = 0; m < N; m++) {
-            double angle = 2 * PI * m * n / N;
-            output[n] += input[m] * exp(Complex(0, angle));
+    // Досчитывает кадры, накрывающие поступившие отсчеты, и возвращает
+    // оставшиеся latency() + (неполный шаг) выходных отсчетов
+    vector<double> flush() {
+        vector<double> out;
+        int remaining = latency() + pending;
+        vector<double> zeros(hop, 0.0);
+        while ((int)out.size() < remaining) {
+            process(zeros.data(), hop - pending, out);
         }
-        output[n] /= N;
+        out.resize(remaining);
+        reset();
+        return out;
     }
-    return output;
-}
 
-vector<Complex> fft(const vector<Complex>& input) {
-    int N = input.size();
+    void reset() {
+        fill(input.begin(), input.end(), 0.0);
+        fill(accumulator.begin(), accumulator.end(), 0.0);
+        pending = 0;
+    }
+
+private:
+    int N, hop;
+    SpectrumCallback modify;
+    RealFFTPlan forward, backward;
+    vector<double> window, synthesis;
+    vector<double> input;           // последние N входных отсчетов
+    vector<double> frame;
+    vector<double> accumulator;     // сумма перекрывающихся кадров
+    vector<Complex> spectrum;
+    int pending;
+
+    void runFrame(vector<double>& out) {
+        for (int n = 0; n < N; n++) frame[n] = input[n] * window[n];
+        forward.execute(frame.data(), spectrum.data());
+        if (modify) modify(spectrum);
+        backward.execute(spectrum.data(), frame.data());
+        for (int n = 0; n < N; n++) accumulator[n] += frame[n] * synthesis[n];
 
-    if (N == 1) {
-        return input;
+        // первые hop отсчетов больше не получат вкладов
+        out.insert(out.end(), accumulator.begin(), accumulator.begin() + hop);
+        copy(accumulator.begin() + hop, accumulator.end(), accumulator.begin());
+        fill(accumulator.end() - hop, accumulator.end(), 0.0);
+        copy(input.begin() + hop, input.end(), input.begin());
+        pending = 0;
     }
+};
 
-    int M = N / 2;
+// Поток из отсчетов signal порциями по chunk: КИХ-фильтр нижних частот (сохраняются
+// частоты до 10%, как в filterHighFrequencies) и STFT без изменения спектра
+void demonstrateStreamingFilter(const vector<Complex>& signal, int chunk) {
+    vector<double> x = realPart(signal);
+    vector<double> h = frequencySampledFIR([](double f) { return f <= 0.1 ? 1.0 : 0.0; }, 63);
 
-    // 1. Разделяем на четные и нечетные
-    vector<Complex> u(M), v(M);
-    for (int k = 0; k < M; k++) {
-        u[k] = input[2 * k];      // z(2k)
-        v[k] = input[2 * k + 1];  // z(2k+1)
+    // эталон: прямая линейная свертка всей записи
+    vector<double> reference(x.size() + h.size() - 1, 0.0);
+    for (size_t n = 0; n < x.size(); n++) {
+        for (size_t k = 0; k < h.size(); k++) reference[n + k] += x[n] * h[k];
     }
 
-    // 2. Рекурсивно вычисляем FFT для половин
-    vector<Complex> u_hat = fft(u);
-    vector<Complex> v_hat = fft(v);
+    for (StreamMethod method : { StreamMethod::OverlapSave, StreamMethod::OverlapAdd }) {
+        StreamingConvolver convolver(h, method);
+        vector<double> y;
+        for (size_t pos = 0; pos < x.size(); pos += chunk) {
+            int count = min<size_t>(chunk, x.size() - pos);
+            convolver.process(x.data() + pos, count, y);
+        }
+        vector<double> rest = convolver.flush();
+        y.insert(y.end(), rest.begin(), rest.end());
 
-    // 3. Объединяем результаты
-    vector<Complex> output(N);
+        double error = 0;
+        for (size_t n = 0; n < reference.size(); n++) error = max(error, abs(y[n] - reference[n]));
+        cout << (method == StreamMethod::OverlapSave ? "Overlap-save" : "Overlap-add")
+            << ": КИХ " << h.size() << " отсчетов, БПФ " << convolver.fftSize()
+            << ", задержка до " << convolver.latency() << " отсчетов, расхождение с прямой сверткой "
+            << error << endl;
+    }
+
+    StreamingSTFT stft(64, 16, nullptr);
+    vector<double> y;
+    for (size_t pos = 0; pos < x.size(); pos += chunk) {
+        int count = min<size_t>(chunk, x.size() - pos);
+        stft.process(x.data() + pos, count, y);
+    }
+    vector<double> rest = stft.flush();
+    y.insert(y.end(), rest.begin(), rest.end());
+
+    double error = 0;
+    for (size_t n = 0; n < x.size(); n++) error = max(error, abs(y[n + stft.latency()] - x[n]));
+    cout << "STFT (кадр " << stft.frameSize() << ", шаг " << stft.hopSize() << "): задержка "
+        << stft.latency() << " отсчетов, ошибка восстановления " << error << endl;
+}
+
+// ==================== КИХ-ФИЛЬТРЫ ====================
 
-    for (int m = 0; m < M; m++) {
-        // 3. Для m = 0...M-1
-        double angle = -2 * PI * m / N;
-        Complex twiddle = exp(Complex(0, angle));
-        output[m] = u_hat[m] + twiddle * v_hat[m];
+// Проектирование линейно-фазовых фильтров нижних частот (частоты - доли частоты
+// дискретизации, 0..0.5) и три движка потоковой свертки с общим интерфейсом
+// process/flush. FIRFilter выбирает движок по длине фильтра.
 
-        // 4. Для m = M...N-1
-        int l = m;
-        output[m + M] = u_hat[l] - twiddle * v_hat[l];
+double besselI0(double x) {
+    double sum = 1, term = 1;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if (term < sum * 1e-17) break;
     }
+    return sum;
+}
 
-    return output;
+// Идеальный фильтр 2 fc sinc(2 fc (n - c)) с окном Кайзера, нормированный на
+// единичное усиление в нуле; taps нечетно
+vector<double> windowedSincLowPass(double cutoff, int taps, double beta = 8.0) {
+    if (taps < 1 || taps % 2 == 0 || cutoff <= 0 || cutoff >= 0.5) {
+        throw invalid_argument("windowedSincLowPass: нужны нечетное число отсчетов и 0 < cutoff < 0.5");
+    }
+    int center = taps / 2;
+    vector<double> h(taps);
+    double sum = 0;
+    for (int n = 0; n < taps; n++) {
+        double t = n - center;
+        double ideal = t == 0 ? 2 * cutoff : sin(2 * PI * cutoff * t) / (PI * t);
+        double r = center == 0 ? 0 : t / center;
+        h[n] = ideal * besselI0(beta * sqrt(max(0.0, 1 - r * r))) / besselI0(beta);
+        sum += h[n];
+    }
+    for (double& v : h) v /= sum;
+    return h;
 }
 
-vector<Complex> ifft(const vector<Complex>& input) {
-    int N = input.size();
+// Формулы Кайзера: длина и beta по ширине переходной полосы и затуханию (дБ)
+vector<double> kaiserLowPass(double cutoff, double transition, double attenuation_db) {
+    double beta = attenuation_db > 50 ? 0.1102 * (attenuation_db - 8.7)
+        : attenuation_db >= 21 ? 0.5842 * pow(attenuation_db - 21, 0.4) + 0.07886 * (attenuation_db - 21)
+        : 0.0;
+    int taps = (int)ceil((attenuation_db - 7.95) / (14.36 * transition)) + 1;
+    if (taps % 2 == 0) taps++;
+    return windowedSincLowPass(cutoff, max(taps, 3), beta);
+}
 
-    // z(-j) = z(N-j) - используем свойство периодичности
-    vector<Complex> conjugated_input(N);
-    for (int j = 0; j < N; j++) {
-        conjugated_input[j] = conj(input[j]);
+// Равноволновой фильтр Паркса - Макклеллана (обмен Ремеза), тип I:
+// A(f) = sum_{k=0}^{L} a_k cos(2 pi k f), taps = 2L + 1. Полоса пропускания [0, passEdge],
+// подавления [stopEdge, 0.5], вес ошибки в полосе подавления stopWeight.
+// В double достижимы пульсации примерно до 1e-12, более длинные фильтры не нужны.
+vector<double> parksMcClellanLowPass(int taps, double passEdge, double stopEdge, double stopWeight = 1.0) {
+    if (taps < 3 || taps % 2 == 0 || !(0 < passEdge && passEdge < stopEdge && stopEdge < 0.5)) {
+        throw invalid_argument("parksMcClellanLowPass: неверные параметры");
     }
+    int L = taps / 2;
+    int R = L + 2;  // число точек альтернанса
 
-    // Вычисляем FFT от сопряженного
-    vector<Complex> temp = fft(conjugated_input);
+    // Сетка по обеим полосам, плотность 16 точек на экстремум
+    int gridSize = 16 * R;
+    double bandwidth = passEdge + (0.5 - stopEdge);
+    int passCount = max(2, (int)round(gridSize * passEdge / bandwidth));
+    int stopCount = max(2, gridSize - passCount);
+    vector<double> gridF, gridD, gridW;
+    for (int i = 0; i < passCount; i++) {
+        gridF.push_back(passEdge * i / (passCount - 1));
+        gridD.push_back(1);
+        gridW.push_back(1);
+    }
+    for (int i = 0; i < stopCount; i++) {
+        gridF.push_back(stopEdge + (0.5 - stopEdge) * i / (stopCount - 1));
+        gridD.push_back(0);
+        gridW.push_back(stopWeight);
+    }
+    int G = gridF.size();
+    vector<double> gridX(G);
+    for (int i = 0; i < G; i++) gridX[i] = cos(2 * PI * gridF[i]);
 
-    // Сопрягаем результат и делим на N
-    vector<Complex> output(N);
-    for (int j = 0; j < N; j++) {
-        output[j] = conj(temp[j]) / double(N);
+    // Барицентрические веса 1 / prod (x_i - x_j); считаются в логарифмах,
+    // общий множитель на формулы не влияет
+    auto baryWeights = [](const vector<double>& x, int count) {
+        vector<double> logs(count), signs(count, 1.0);
+        double maxLog = -1e300;
+        for (int i = 0; i < count; i++) {
+            double s = 0;
+            for (int j = 0; j < count; j++) {
+                if (j == i) continue;
+                double d = x[i] - x[j];
+                if (d < 0) signs[i] = -signs[i];
+                s -= log(abs(d));
+            }
+            logs[i] = s;
+            maxLog = max(maxLog, s);
+        }
+        vector<double> w(count);
+        for (int i = 0; i < count; i++) w[i] = signs[i] * exp(logs[i] - maxLog);
+        return w;
+    };
+
+    vector<int> extremal(R);
+    for (int i = 0; i < R; i++) extremal[i] = (int)((long long)i * (G - 1) / (R - 1));
+
+    vector<double> ex(R), exC(L + 1), interpW;
+    auto amplitude = [&](double x) {
+        double num = 0, den = 0;
+        for (int i = 0; i <= L; i++) {
+            double d = x - ex[i];
+            if (d == 0) return exC[i];
+            double t = interpW[i] / d;
+            num += t * exC[i];
+            den += t;
+        }
+        return num / den;
+    };
+
+    // Решение на наборе extremal: delta, интерполянт A и ошибка на сетке
+    vector<double> error(G);
+    double delta = 0;
+    auto solve = [&](const vector<int>& extremal) {
+        for (int i = 0; i < R; i++) ex[i] = gridX[extremal[i]];
+
+        // delta - уровень равноволновой ошибки на текущем наборе точек
+        vector<double> b = baryWeights(ex, R);
+        double num = 0, den = 0;
+        for (int i = 0; i < R; i++) {
+            int k = extremal[i];
+            num += b[i] * gridD[k];
+            den += b[i] * (i % 2 == 0 ? 1 : -1) / gridW[k];
+        }
+        delta = num / den;
+
+        // A интерполирует D - (-1)^i delta / W в первых L + 1 точках
+        for (int i = 0; i <= L; i++) {
+            int k = extremal[i];
+            exC[i] = gridD[k] - (i % 2 == 0 ? 1 : -1) * delta / gridW[k];
+        }
+        interpW = baryWeights(ex, L + 1);
+
+        double maxError = 0;
+        for (int k = 0; k < G; k++) {
+            error[k] = gridW[k] * (gridD[k] - amplitude(gridX[k]));
+            maxError = max(maxError, abs(error[k]));
+        }
+        return maxError;
+    };
+
+    // Когда пульсации доходят до уровня ошибок округления, обмен перестает сходиться;
+    // тогда берется лучший из пройденных наборов
+    vector<int> best = extremal;
+    double bestError = 1e300;
+    for (int iteration = 0; iteration < 100; iteration++) {
+        double maxError = solve(extremal);
+        if (maxError < bestError) {
+            bestError = maxError;
+            best = extremal;
+        }
+
+        // Новые точки: локальные экстремумы ошибки (края полос сравниваются
+        // только с соседями из своей полосы), знаки чередуются
+        vector<int> candidates;
+        for (int k = 0; k < G; k++) {
+            bool left = k == 0 || k == passCount || (error[k] > 0 ? error[k] >= error[k - 1] : error[k] <= error[k - 1]);
+            bool right = k == G - 1 || k == passCount - 1 || (error[k] > 0 ? error[k] >= error[k + 1] : error[k] <= error[k + 1]);
+            if (left && right) {
+                if (!candidates.empty() && (error[candidates.back()] > 0) == (error[k] > 0)) {
+                    if (abs(error[k]) > abs(error[candidates.back()])) candidates.back() = k;
+                }
+                else {
+                    candidates.push_back(k);
+                }
+            }
+        }
+        // Лишние точки: наименьший экстремум выбрасывается, его соседи (одного знака)
+        // сливаются; если лишняя одна точка, чередование сохраняет только удаление края
+        while ((int)candidates.size() > R) {
+            if ((int)candidates.size() == R + 1) {
+                if (abs(error[candidates.front()]) < abs(error[candidates.back()])) candidates.erase(candidates.begin());
+                else candidates.pop_back();
+                break;
+            }
+            size_t weakest = 0;
+            for (size_t i = 1; i < candidates.size(); i++) {
+                if (abs(error[candidates[i]]) < abs(error[candidates[weakest]])) weakest = i;
+            }
+            candidates.erase(candidates.begin() + weakest);
+            if (weakest > 0 && weakest < candidates.size()) {
+                if (abs(error[candidates[weakest]]) > abs(error[candidates[weakest - 1]])) {
+                    candidates[weakest - 1] = candidates[weakest];
+                }
+                candidates.erase(candidates.begin() + weakest);
+            }
+        }
+        if ((int)candidates.size() < R || candidates == extremal) break;
+        extremal = candidates;
+        if (maxError - abs(delta) <= 1e-9 * abs(delta)) break;
     }
+    solve(best);
 
-    return output;
+    // h[n] = (1 / M) (A(0) + 2 sum_{j=1}^{L} A(f_j) cos(2 pi f_j (n - L))), f_j = j / M
+    vector<double> samples(L + 1);
+    for (int j = 0; j <= L; j++) samples[j] = amplitude(cos(2 * PI * j / taps));
+    vector<double> h(taps);
+    for (int n = 0; n < taps; n++) {
+        double sum = samples[0];
+        for (int j = 1; j <= L; j++) sum += 2 * samples[j] * cos(2 * PI * j * (n - L) / taps);
+        h[n] = sum / taps;
+    }
+    return h;
 }
 
-// ==================== ПУНКТ 2: ГЕНЕРАЦИЯ СИГНАЛОВ ====================
+// Свертка во временной области по одному отсчету, без задержки, O(M) на отсчет.
+// Линия задержки хранится дважды подряд, чтобы последние M отсчетов лежали непрерывно.
+class DirectConvolver {
+public:
+    explicit DirectConvolver(const vector<double>& h)
+        : M(h.size()), reversed(h.rbegin(), h.rend()), line(2 * h.size()) {
+        if (M < 1) throw invalid_argument("DirectConvolver: пустой фильтр");
+        reset();
+    }
 
-struct SignalParams {
-    int N;
-    double A, B;
-    double omega1, omega2;
-    double phi;
+    int latency() const { return 0; }
+
+    void process(const double* in, int count, vector<double>& out) {
+        for (int i = 0; i < count; i++) {
+            pos = pos + 1 == M ? 0 : pos + 1;
+            line[pos] = line[pos + M] = in[i];
+            const double* x = line.data() + pos + 1;
+            double sum = 0;
+            for (int j = 0; j < M; j++) sum += reversed[j] * x[j];
+            out.push_back(sum);
+        }
+        received += count;
+    }
+
+    vector<double> flush() {
+        vector<double> out;
+        vector<double> zeros(M - 1, 0.0);
+        process(zeros.data(), M - 1, out);
+        reset();
+        return out;
+    }
+
+    void reset() {
+        fill(line.begin(), line.end(), 0.0);
+        pos = 0;
+        received = 0;
+    }
+
+private:
+    int M;
+    vector<double> reversed;
+    vector<double> line;
+    int pos;
+    long long received;
 };
 
-vector<Complex> generateSignal1(const SignalParams& params) {
-    vector<Complex> signal(params.N);
-    for (int j = 0; j < params.N; j++) {
-        double value = params.A * cos(2 * PI * params.omega1 * j / params.N + params.phi) +
-            params.B * cos(2 * PI * params.omega2 * j / params.N);
-        signal[j] = value;
+// Равномерно разбитая свертка: фильтр режется на P частей по B отсчетов, для
+// каждого блока входа считается одно БПФ длины 2B, спектры последних P блоков
+// (частотная линия задержки) умножаются на спектры частей и суммируются.
+// Задержка B - 1 отсчетов при любой длине фильтра, O(log B + P) на отсчет.
+class PartitionedConvolver {
+public:
+    PartitionedConvolver(const vector<double>& h, int blockSize)
+        : M(h.size()), B(blockSize), P((h.size() + blockSize - 1) / blockSize),
+        forward(2 * blockSize), backward(2 * blockSize, true) {
+        if (M < 1 || B < 1) throw invalid_argument("PartitionedConvolver: неверные размеры");
+        int K = B + 1;
+        parts.assign((size_t)P * K, Complex(0));
+        vector<double> padded(2 * B);
+        for (int p = 0; p < P; p++) {
+            fill(padded.begin(), padded.end(), 0.0);
+            int count = min(B, M - p * B);
+            copy(h.begin() + p * B, h.begin() + p * B + count, padded.begin());
+            forward.execute(padded.data(), parts.data() + (size_t)p * K);
+        }
+        history.resize((size_t)P * K);
+        input.resize(2 * B);
+        frame.resize(2 * B);
+        sum.resize(K);
+        reset();
     }
-    return signal;
-}
 
-vector<Complex> generateSignal2(const SignalParams& params) {
-    vector<Complex> signal(params.N, 0);
-    for (int j = params.N / 4; j <= params.N / 2; j++) {
-        signal[j] = params.A + params.B * cos(2 * PI * params.omega2 * j / params.N);
+    int blockSize() const { return B; }
+    int partitions() const { return P; }
+    int latency() const { return B - 1; }
+
+    void process(const double* in, int count, vector<double>& out) {
+        while (count > 0) {
+            int take = min(count, B - filled);
+            copy(in, in + take, input.begin() + B + filled);
+            filled += take;
+            received += take;
+            in += take;
+            count -= take;
+            if (filled == B) runBlock(out, B);
+        }
     }
-    for (int j = 3 * params.N / 4; j < params.N; j++) {
-        signal[j] = params.A + params.B * cos(2 * PI * params.omega2 * j / params.N);
+
+    vector<double> flush() {
+        vector<double> out;
+        long long total = received + M - 1;
+        while (emitted < total) {
+            fill(input.begin() + B + filled, input.end(), 0.0);
+            filled = B;
+            runBlock(out, (int)min<long long>(B, total - emitted));
+        }
+        reset();
+        return out;
     }
-    return signal;
-}
 
-// ==================== ПУНКТ 3: АНАЛИЗ И СРАВНЕНИЕ ====================
+    void reset() {
+        fill(input.begin(), input.end(), 0.0);
+        fill(history.begin(), history.end(), Complex(0));
+        newest = 0;
+        filled = 0;
+        received = emitted = 0;
+    }
 
-struct TimingResults {
-    long long dft_time;
-    long long fft_time;
-};
+private:
+    int M, B, P;
+    RealFFTPlan forward, backward;
+    vector<Complex> parts;      // P спектров частей фильтра по B + 1 частот
+    vector<Complex> history;    // спектры последних P блоков входа, кольцо
+    vector<Complex> sum;
+    vector<double> input;       // предыдущий и текущий блоки
+    vector<double> frame;
+    int newest;
+    int filled;
+    long long received, emitted;
 
-struct AnalysisResults {
-    vector<Complex> dft_result;
-    vector<Complex> fft_result;
-    TimingResults timing;
-};
+    void runBlock(vector<double>& out, int keep) {
+        int K = B + 1;
+        newest = newest == 0 ? P - 1 : newest - 1;
+        forward.execute(input.data(), history.data() + (size_t)newest * K);
 
-void printResultsTable(const vector<Complex>& signal, const vector<Complex>& dft_result) {
-    cout << fixed << setprecision(6);
-    cout << setw(4) << "m" << setw(12) << "Re z" << setw(15) << "Re z_hat"
-        << setw(15) << "Im z_hat" << setw(15) << "Amplitude" << setw(12) << "Phase" << endl;
-    cout << string(75, '-') << endl;
+        fill(sum.begin(), sum.end(), Complex(0));
+        for (int p = 0; p < P; p++) {
+            const Complex* x = history.data() + (size_t)((newest + p) % P) * K;
+            const Complex* hp = parts.data() + (size_t)p * K;
+            for (int k = 0; k < K; k++) sum[k] += x[k] * hp[k];
+        }
+        backward.execute(sum.data(), frame.data());
 
-    int N = signal.size();
-    double amplitude_limit = 1e-6;
-    double phase_limit = 1e-6;
-    int count = 0;
+        // overlap-save: первая половина испорчена циклическим переносом
+        out.insert(out.end(), frame.begin() + B, frame.begin() + B + keep);
+        copy(input.begin() + B, input.end(), input.begin());
+        emitted += keep;
+        filled = 0;
+    }
+};
 
-    for (int m = 0; m < N; m++) {
-        double amplitude = abs(dft_result[m]);
-        double phase = arg(dft_result[m]);
+enum class ConvolutionEngine { Auto, Direct, FFT, Partitioned };
 
-        bool significant_amplitude = (amplitude > amplitude_limit);
-        bool significant_phase = (abs(phase) > phase_limit);
+const int DIRECT_MAX_TAPS = 64;
 
-        if (significant_amplitude) { // вариант без  '|| significant_phase'
-            cout << setw(4) << m << setw(12) << signal[m].real()
-                << setw(15) << dft_result[m].real()
-                << setw(15) << dft_result[m].imag()
-                << setw(15) << amplitude
-                << setw(12) << phase << endl;
-            count++;
+// Потоковый КИХ-фильтр. Auto: короткие фильтры (до DIRECT_MAX_TAPS) - прямая свертка,
+// длинные - overlap-save одним БПФ длины ~2M (O(log M) на отсчет), а если задан
+// maxLatency меньше длины фильтра - разбитая свертка с блоком maxLatency + 1.
+class FIRFilter {
+public:
+    FIRFilter(const vector<double>& h, ConvolutionEngine engine = ConvolutionEngine::Auto, int maxLatency = 0)
+        : taps(h), engine_(engine) {
+        int M = h.size();
+        if (engine_ == ConvolutionEngine::Auto) {
+            engine_ = M <= DIRECT_MAX_TAPS ? ConvolutionEngine::Direct
+                : maxLatency > 0 && maxLatency < M ? ConvolutionEngine::Partitioned
+                : ConvolutionEngine::FFT;
+        }
+        switch (engine_) {
+        case ConvolutionEngine::Direct:
+            direct.reset(new DirectConvolver(h));
+            break;
+        case ConvolutionEngine::Partitioned:
+            partitioned.reset(new PartitionedConvolver(h, maxLatency > 0 ? maxLatency + 1 : nextPowerOfTwo((int)ceil(sqrt((double)M)))));
+            break;
+        default:
+            fast.reset(new StreamingConvolver(h, StreamMethod::OverlapSave));
+            break;
         }
     }
 
-    cout << defaultfloat;
-    cout << "Всего выведено компонент: " << count << " из " << N << endl;
-}
+    ConvolutionEngine engine() const { return engine_; }
+    int length() const { return taps.size(); }
+    int latency() const {
+        return direct ? direct->latency() : partitioned ? partitioned->latency() : fast->latency();
+    }
 
-AnalysisResults analyzeSignal(const vector<Complex>& signal) {
-    AnalysisResults results;
+    void process(const double* in, int count, vector<double>& out) {
+        if (direct) direct->process(in, count, out);
+        else if (partitioned) partitioned->process(in, count, out);
+        else fast->process(in, count, out);
+    }
 
-    auto start_dft = high_resolution_clock::now();
-    results.dft_result = dft(signal);
-    auto end_dft = high_resolution_clock::now();
+    vector<double> flush() {
+        return direct ? direct->flush() : partitioned ? partitioned->flush() : fast->flush();
+    }
 
-    auto start_fft = high_resolution_clock::now();
-    results.fft_result = fft(signal);
-    auto end_fft = high_resolution_clock::now();
+    // Вся запись сразу: выход той же длины, сдвинутый на групповую задержку (M - 1) / 2
+    vector<double> filter(const vector<double>& x) {
+        vector<double> y;
+        y.reserve(x.size() + taps.size());
+        process(x.data(), x.size(), y);
+        vector<double> rest = flush();
+        y.insert(y.end(), rest.begin(), rest.end());
+        int delay = (taps.size() - 1) / 2;
+        return vector<double>(y.begin() + delay, y.begin() + delay + x.size());
+    }
 
-    results.timing.dft_time = duration_cast<microseconds>(end_dft - start_dft).count();
-    results.timing.fft_time = duration_cast<microseconds>(end_fft - start_fft).count();
+private:
+    vector<double> taps;
+    ConvolutionEngine engine_;
+    unique_ptr<DirectConvolver> direct;
+    unique_ptr<StreamingConvolver> fast;
+    unique_ptr<PartitionedConvolver> partitioned;
+};
 
-    return results;
+const char* engineName(ConvolutionEngine engine) {
+    switch (engine) {
+    case ConvolutionEngine::Direct: return "прямая";
+    case ConvolutionEngine::FFT: return "БПФ (overlap-save)";
+    case ConvolutionEngine::Partitioned: return "разбитая";
+    default: return "авто";
+    }
 }
 
-// ==================== ПУНКТ 4: ФИЛЬТРАЦИЯ ШУМА ====================
-
-vector<Complex> filterHighFrequencies(const vector<Complex>& dft_result) {
-    int N = dft_result.size();
-    vector<Complex> filtered = dft_result;
+// Наихудшее усиление фильтра в полосе [from, 0.5], дБ
+double stopbandGainDb(const vector<double>& h, double from) {
+    int N = nextPowerOfTwo(16 * h.size());
+    vector<double> padded(N, 0.0);
+    copy(h.begin(), h.end(), padded.begin());
+    vector<Complex> response = rfft(padded);
+    double worst = 0;
+    for (int k = (int)ceil(from * N); k <= N / 2; k++) worst = max(worst, abs(response[k]));
+    return 20 * log10(max(worst, 1e-300));
+}
 
-    // Оставляем только низкие частоты (первые и последние 10%)
-    int keep_count = N / 10; // 10% от N
+// Фильтры нижних частот с частотой среза cutoff вместо обнуления частот
+void demonstrateFIRFilters(const vector<Complex>& signal, double cutoff) {
+    vector<double> x = realPart(signal);
+    double transition = 0.05;
 
-    cout << "Простая фильтрация:" << endl;
-    cout << "Сохраняем частоты: m = 0..." << keep_count << " и " << N - keep_count << "...N-1" << endl;
-    cout << "Обнуляем все остальные частоты" << endl;
+    vector<double> kaiser = kaiserLowPass(cutoff, transition, 60);
+    vector<double> remez = parksMcClellanLowPass(kaiser.size(), cutoff - transition / 2, cutoff + transition / 2, 10);
 
-    int removed_count = 0;
-    for (int k = keep_count + 1; k < N - keep_count; k++) {
-        if (abs(filtered[k]) > 1e-6) {
-            removed_count++;
-        }
-        filtered[k] = 0;
+    cout << "Частота среза " << cutoff << " (доля частоты дискретизации), переходная полоса "
+        << transition << endl;
+    for (int design = 0; design < 2; design++) {
+        const vector<double>& h = design == 0 ? kaiser : remez;
+        FIRFilter filter(h);
+        vector<double> y = filter.filter(x);
+        double energy = 0;
+        for (double v : y) energy += v * v;
+        cout << (design == 0 ? "Окно Кайзера:       " : "Паркс - Макклеллан: ") << h.size()
+            << " отсчетов, подавление " << -stopbandGainDb(h, cutoff + transition / 2)
+            << " дБ, движок: " << engineName(filter.engine())
+            << ", СКЗ выхода " << sqrt(energy / y.size()) << endl;
     }
 
-    cout << "Удалено компонент с ненулевой амплитудой: " << removed_count << endl;
-    return filtered;
+    // Стоимость на отсчет для длинного фильтра
+    vector<double> longFilter = windowedSincLowPass(cutoff, 2047);
+    vector<double> stream(1 << 16);
+    for (size_t n = 0; n < stream.size(); n++) stream[n] = x[n % x.size()];
+    for (ConvolutionEngine engine : { ConvolutionEngine::Direct, ConvolutionEngine::FFT, ConvolutionEngine::Partitioned }) {
+        FIRFilter filter(longFilter, engine, engine == ConvolutionEngine::Partitioned ? 127 : 0);
+        vector<double> y;
+        y.reserve(stream.size() + longFilter.size());
+        auto start = high_resolution_clock::now();
+        filter.process(stream.data(), stream.size(), y);
+        auto stop = high_resolution_clock::now();
+        cout << "КИХ " << longFilter.size() << " отсчетов, " << engineName(engine) << ": "
+            << duration_cast<nanoseconds>(stop - start).count() / double(stream.size())
+            << " нс/отсчет, задержка " << filter.latency() << endl;
+    }
 }
 
 // ==================== ПУНКТ 5: ВИЗУАЛИЗАЦИЯ И ЭКСПОРТ ====================
@@ -249,6 +3741,20 @@ void exportToCSV(const string& filename,
     cout << "Данные экспортированы в файл: " << filename << endl;
 }
 
+// Вещественные сигналы и половины их спектров; формат файла тот же,
+// частоты N/2+1..N-1 восстанавливаются сопряжением
+void exportToCSV(const string& filename,
+    const vector<double>& original_signal,
+    const vector<double>& filtered_signal,
+    const vector<Complex>& half_original,
+    const vector<Complex>& half_filtered) {
+    int N = original_signal.size();
+    vector<Complex> original(original_signal.begin(), original_signal.end());
+    vector<Complex> filtered(filtered_signal.begin(), filtered_signal.end());
+    exportToCSV(filename, original, filtered,
+        expandHalfSpectrum(half_original, N), expandHalfSpectrum(half_filtered, N));
+}
+
 // ==================== ПУНКТ 6: АНАЛИЗ СИГНАЛА С РАЗРЫВАМИ ====================
 
 void exportDiscontinuousSignal(const string& filename, const vector<Complex>& signal) {
@@ -283,11 +3789,289 @@ void printSectionHeader(const string& title) {
     cout << title << "\n\n";
 }
 
+double maxAbsDifference(const vector<Complex>& a, const vector<Complex>& b) {
+    double result = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        result = max(result, abs(a[i] - b[i]));
+    }
+    return result;
+}
+
+// ==================== ЗАМЕР ПРОИЗВОДИТЕЛЬНОСТИ ====================
+
+// Режим --bench: для N = 2^minLog2..2^maxLog2 все варианты преобразования
+// сравниваются по времени, выделениям памяти и точности относительно
+// БПФ в long double. Для вариантов БПФ ошибка сверяется с fftErrorBound
+// (float-варианты с суффиксом 32). Результат - таблица и CSV.
+
+// Столбец allocs считается заменой глобальных operator new/delete, а она действует
+// на всю программу (каждое выделение проходит через атомарный счетчик). Поэтому
+// замена есть только в сборке для замеров с -DFFT_COUNT_ALLOCATIONS, в обычной
+// сборке столбец пустой.
+#ifdef FFT_COUNT_ALLOCATIONS
+const bool COUNT_ALLOCATIONS = true;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"   // new и delete ниже оба на malloc/free
+#endif
+atomic<long long> allocationCount{ 0 };
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, align_val_t alignment) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    size_t a = (size_t)alignment;
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(size ? size : 1, a);
+#else
+    void* p = aligned_alloc(a, (max<size_t>(size, 1) + a - 1) / a * a);
+#endif
+    if (p) return p;
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#ifdef _MSC_VER
+void operator delete(void* p, align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+long long allocationsSoFar() { return allocationCount.load(); }
+#else
+const bool COUNT_ALLOCATIONS = false;
+
+long long allocationsSoFar() { return 0; }
+#endif
+
+using LongComplex = complex<long double>;
+const long double PI_L = 3.141592653589793238462643383279502884L;
+
+// Эталон: БПФ по основанию 2 в long double, каждый поворотный множитель
+// считается отдельно через cosl/sinl (без накопления ошибки рекуррентности)
+vector<LongComplex> referenceFFT(const vector<Complex>& input) {
+    int N = input.size();
+    vector<LongComplex> data(input.begin(), input.end());
+    for (int i = 1, j = 0; i < N; i++) {
+        int bit = N >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) swap(data[i], data[j]);
+    }
+    vector<LongComplex> twiddles(N / 2);
+    for (int k = 0; k < N / 2; k++) {
+        long double angle = -2 * PI_L * k / N;
+        twiddles[k] = LongComplex(cosl(angle), sinl(angle));
+    }
+    for (int len = 2; len <= N; len <<= 1) {
+        int half = len / 2, step = N / len;
+        for (int i = 0; i < N; i += len) {
+            for (int k = 0; k < half; k++) {
+                LongComplex t = twiddles[k * step] * data[i + k + half];
+                data[i + k + half] = data[i + k] - t;
+                data[i + k] += t;
+            }
+        }
+    }
+    return data;
+}
+
+struct AccuracyStats {
+    double max_error;   // max |X - X_ref| / max |X_ref|
+    double rms_error;   // ||X - X_ref||_2 / ||X_ref||_2
+};
+
+// result может быть длиннее эталона (пакет из нескольких копий) или короче (rfft)
+template <typename Real>
+AccuracyStats compareWithReference(const complex<Real>* result, size_t count, const vector<LongComplex>& reference) {
+    long double max_diff = 0, max_ref = 0, diff2 = 0, ref2 = 0;
+    size_t N = reference.size();
+    for (size_t i = 0; i < count; i++) {
+        const LongComplex& r = reference[i % N];
+        long double d = abs(LongComplex(result[i].real(), result[i].imag()) - r);
+        max_diff = max(max_diff, d);
+        max_ref = max(max_ref, abs(r));
+        diff2 += d * d;
+        ref2 += norm(r);
+    }
+    return { (double)(max_diff / max_ref), (double)sqrtl(diff2 / ref2) };
+}
+
+// Время одного вызова в нс: прогрев (планы, кэши), подбор числа повторов,
+// чтобы серия шла не меньше 10 мс, лучшая из трех серий. allocations - среднее
+// число выделений памяти за вызов (NaN, если сборка без FFT_COUNT_ALLOCATIONS)
+template <typename F>
+double timePerCall(F&& call, double& allocations) {
+    call();
+    long long reps = 1;
+    while (true) {
+        auto start = high_resolution_clock::now();
+        for (long long r = 0; r < reps; r++) call();
+        auto stop = high_resolution_clock::now();
+        if (stop - start >= milliseconds(10) || reps >= (1 << 20)) break;
+        reps *= 2;
+    }
+
+    const int SAMPLES = 3;
+    double best = 1e300;
+    long long before = allocationsSoFar();
+    for (int sample = 0; sample < SAMPLES; sample++) {
+        auto start = high_resolution_clock::now();
+        for (long long r = 0; r < reps; r++) call();
+        auto stop = high_resolution_clock::now();
+        best = min(best, duration_cast<nanoseconds>(stop - start).count() / double(reps));
+    }
+    allocations = COUNT_ALLOCATIONS ? double(allocationsSoFar() - before) / (SAMPLES * reps)
+        : numeric_limits<double>::quiet_NaN();
+    return best;
+}
+
+struct BenchmarkRow {
+    string variant;
+    int N;
+    double ns_per_point;
+    double gflops;          // 5 N log2 N / время; для rfft 2.5 N log2 N
+    double allocations;     // за вызов; NaN - не считались
+    AccuracyStats accuracy;
+    double error_bound;     // fftErrorBound; 0 - не проверяется
+};
+
+const int DFT_BENCH_MAX = 1 << 12;      // O(N^2): дальше слишком долго
+const int BATCH_BENCH_POINTS = 1 << 20; // отсчетов во всем пакете
+
+void runBenchmark(int minLog2, int maxLog2, const string& csvFile) {
+    int threads = defaultThreadCount();
+    vector<BenchmarkRow> rows;
+    mt19937 rng(42);
+    uniform_real_distribution<double> uniform(-1, 1);
+
+    cout << "Потоков: " << threads << ", SIMD: " << simdLevelName(activeSimdLevel()) << endl;
+    cout << setw(10) << "variant" << setw(10) << "N" << setw(12) << "ns/point" << setw(10) << "GFLOP/s"
+        << setw(10) << "allocs" << setw(13) << "max err" << setw(13) << "rms err" << setw(13) << "bound" << endl;
+
+    int violations = 0;
+    auto add = [&](const string& variant, int N, double ns, double flops, double allocations, AccuracyStats accuracy,
+        int points, double bound) {
+        BenchmarkRow row = { variant, N, ns / points, flops / ns, allocations, accuracy, bound };
+        rows.push_back(row);
+        bool violated = bound > 0 && accuracy.rms_error > bound;
+        if (violated) violations++;
+        cout << setw(10) << variant << setw(10) << N << fixed << setprecision(3) << setw(12) << row.ns_per_point
+            << setw(10) << row.gflops << setw(10) << setprecision(1);
+        if (isnan(allocations)) cout << "-";
+        else cout << allocations;
+        cout << scientific << setprecision(2)
+            << setw(13) << accuracy.max_error << setw(13) << accuracy.rms_error << setw(13) << bound
+            << (violated ? " !" : "") << defaultfloat << endl;
+    };
+
+    for (int log2N = minLog2; log2N <= maxLog2; log2N++) {
+        int N = 1 << log2N;
+        double flops = 5.0 * N * log2N;
+        double allocations;
+
+        // Вход точно представим во float: ошибка float-вариантов - только ошибка преобразования
+        vector<Complex> input(N);
+        vector<ComplexF> input_f(N);
+        vector<double> real_input(N);
+        vector<float> real_input_f(N);
+        for (int n = 0; n < N; n++) {
+            input_f[n] = ComplexF(float(uniform(rng)), float(uniform(rng)));
+            input[n] = Complex(input_f[n].real(), input_f[n].imag());
+            real_input[n] = input[n].real();
+            real_input_f[n] = input_f[n].real();
+        }
+        double bound = fftErrorBound<double>(N), bound_f = fftErrorBound<float>(N);
+        vector<LongComplex> reference = referenceFFT(input);
+
+        vector<Complex> output;
+        if (N <= DFT_BENCH_MAX) {
+            double ns = timePerCall([&] { output = dft(input); }, allocations);
+            add("dft", N, ns, flops, allocations, compareWithReference(output.data(), N, reference), N, 0);
+        }
+
+        double ns = timePerCall([&] { output = fft(input); }, allocations);
+        add("fft", N, ns, flops, allocations, compareWithReference(output.data(), N, reference), N, bound);
+
+        // План со стратегией, выбранной замером (FFTPlanning::Measure), вместо оценки по размеру
+        FFTPlan measured(N, false, FFTPlanning::Measure);
+        ns = timePerCall([&] { measured.execute(input, output); }, allocations);
+        add("measured", N, ns, flops, allocations, compareWithReference(output.data(), N, reference), N, bound);
+
+        vector<ComplexF> output_f;
+        ns = timePerCall([&] { output_f = fft(input_f); }, allocations);
+        add("fft32", N, ns, flops, allocations, compareWithReference(output_f.data(), N, reference), N, bound_f);
+
+        ns = timePerCall([&] { output = fft(input, threads); }, allocations);
+        add("threaded", N, ns, flops, allocations, compareWithReference(output.data(), N, reference), N, bound);
+
+        int howmany = max(1, BATCH_BENCH_POINTS / N);
+        vector<Complex> batch_input((size_t)N * howmany), batch_output(batch_input.size());
+        for (int b = 0; b < howmany; b++) copy(input.begin(), input.end(), batch_input.begin() + (size_t)b * N);
+        BatchFFTPlan batch(N, howmany, false, threads);
+        ns = timePerCall([&] { batch.execute(batch_input.data(), batch_output.data()); }, allocations);
+        add("batch", N, ns, flops * howmany, allocations,
+            compareWithReference(batch_output.data(), batch_output.size(), reference), N * howmany, bound);
+        batch_input = vector<Complex>();
+        batch_output = vector<Complex>();
+
+        vector<ComplexF> batch_input_f((size_t)N * howmany), batch_output_f(batch_input_f.size());
+        for (int b = 0; b < howmany; b++) copy(input_f.begin(), input_f.end(), batch_input_f.begin() + (size_t)b * N);
+        BatchFFTPlanF batch_f(N, howmany, false, threads);
+        ns = timePerCall([&] { batch_f.execute(batch_input_f.data(), batch_output_f.data()); }, allocations);
+        add("batch32", N, ns, flops * howmany, allocations,
+            compareWithReference(batch_output_f.data(), batch_output_f.size(), reference), N * howmany, bound_f);
+        batch_input_f = vector<ComplexF>();
+        batch_output_f = vector<ComplexF>();
+
+        vector<Complex> real_reference_input(real_input.begin(), real_input.end());
+        vector<LongComplex> real_reference = referenceFFT(real_reference_input);
+        ns = timePerCall([&] { output = rfft(real_input); }, allocations);
+        add("rfft", N, ns, flops / 2, allocations, compareWithReference(output.data(), N / 2 + 1, real_reference), N, bound);
+
+        ns = timePerCall([&] { output_f = rfft(real_input_f); }, allocations);
+        add("rfft32", N, ns, flops / 2, allocations,
+            compareWithReference(output_f.data(), N / 2 + 1, real_reference), N, bound_f);
+    }
+
+    if (violations > 0) cout << "Оценка ошибки fftErrorBound нарушена в строках: " << violations << endl;
+    else cout << "Ошибка всех вариантов БПФ в пределах fftErrorBound" << endl;
+
+    ofstream file(csvFile);
+    file << "variant,N,ns_per_point,gflops,allocs_per_call,max_rel_error,rms_rel_error,error_bound" << endl;
+    file << setprecision(6);
+    for (const BenchmarkRow& row : rows) {
+        file << row.variant << "," << row.N << "," << row.ns_per_point << "," << row.gflops << ",";
+        if (!isnan(row.allocations)) file << row.allocations;
+        file << "," << row.accuracy.max_error << "," << row.accuracy.rms_error << ","
+            << row.error_bound << endl;
+    }
+    cout << "Результаты записаны в файл: " << csvFile << endl;
+}
+
 // ==================== MAIN ====================
 
-int main() {
+// Аргументы: --bench [maxLog2] - только замер производительности
+int main(int argc, char* argv[]) {
     setlocale(LC_ALL, "Ru");
 
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        int max_log2 = argc > 2 ? atoi(argv[2]) : 24;
+        runBenchmark(4, max_log2, "fft_benchmark.csv");
+        return 0;
+    }
+
     // Параметры сигнала
     SignalParams params;
     params.N = 512;
@@ -297,6 +4081,9 @@ int main() {
     params.omega2 = 184;
     params.phi = PI / 4;
 
+    // Граница фильтра нижних частот, доля частоты дискретизации
+    double filter_cutoff = 0.1;
+
     // ==================== ПУНКТ 2 ====================
     printSectionHeader("ПУНКТ 2: ГЕНЕРАЦИЯ СИГНАЛА");
     vector<Complex> signal = generateSignal1(params);
@@ -308,14 +4095,37 @@ int main() {
 
     cout << "Время выполнения DFT: " << analysis.timing.dft_time << " мкс" << endl;
     cout << "Время выполнения FFT: " << analysis.timing.fft_time << " мкс" << endl;
+    cout << "Время выполнения RFFT: " << analysis.timing.rfft_time << " мкс" << endl;
+    cout << "Максимальное расхождение FFT и DFT: "
+        << maxAbsDifference(analysis.fft_result, analysis.dft_result) << endl;
+    cout << "Максимальное расхождение RFFT и DFT (m = 0..N/2): "
+        << maxAbsDifference(analysis.rfft_result, analysis.dft_result) << endl;
 
     cout << "\nТаблица значимых компонент DFT:" << endl;
     printResultsTable(signal, analysis.dft_result);
 
+    cout << "\nРазреженный спектр (k = 4):" << endl;
+    analyzeSparseSpectrum(params, signal, analysis.dft_result);
+
+    cout << "\nЛупа спектра около omega2:" << endl;
+    analyzeZoomSpectrum(params, signal, analysis.dft_result);
+
+    cout << "\nСпектральная плотность длинной записи:" << endl;
+    analyzeLongRecording(params);
+
     // ==================== ПУНКТ 4 ====================
     printSectionHeader("ПУНКТ 4: ФИЛЬТРАЦИЯ ШУМОВЫХ КОМПОНЕНТ");
 
-    vector<Complex> filtered_dft = filterHighFrequencies(analysis.dft_result);
+    vector<Complex> filtered_dft = filterHighFrequencies(analysis.dft_result, filter_cutoff);
+
+    cout << "\nПотоковая фильтрация (порции по 37 отсчетов):" << endl;
+    demonstrateStreamingFilter(signal, 37);
+
+    cout << "\nКИХ-фильтры вместо обнуления частот:" << endl;
+    demonstrateFIRFilters(signal, filter_cutoff);
+
+    cout << "\nДвумерная фильтрация изображения:" << endl;
+    demonstrateImageFilter(filter_cutoff);
 
     // ==================== ПУНКТ 5 ====================
     printSectionHeader("ПУНКТ 5: ЭКСПОРТ ДАННЫХ ДЛЯ ВИЗУАЛИЗАЦИИ");
@@ -324,6 +4134,16 @@ int main() {
     exportToCSV("signal_analysis.csv", signal, reconstructed,
         analysis.dft_result, filtered_dft);
 
+    // Тот же фильтр на половине спектра, восстановление через IRFFT
+    vector<Complex> filtered_half = filterHighFrequencies(analysis.rfft_result, params.N, filter_cutoff);
+    vector<double> reconstructed_half = irfft(filtered_half, params.N);
+    cout << "Расхождение восстановления через IRFFT и IDFT: "
+        << maxAbsDifference(vector<Complex>(reconstructed_half.begin(), reconstructed_half.end()),
+            reconstructed) << endl;
+
+    cout << "\nСжатие отфильтрованного сигнала (порог 1% от максимума блока):" << endl;
+    compressSignal(realPart(reconstructed), 64, 0.01);
+
     // ==================== ПУНКТ 6 ====================
     analyzeDiscontinuousSignal(params);
 
@@ -4,12 +4,29 @@
 
 namespace SpectralAnalysis
 {
+    void SpectralTransformer::PrepareTwiddles(int size)
+    {
+        if (size == twiddleSize)
+            return;
+
+        int halfSize = size / 2;
+        halfTwiddles.resize(halfSize);
+        fullTwiddles.resize(halfSize);
+        for (int k = 0; k < halfSize; k++)
+        {
+            halfTwiddles[k] = std::polar(1.0, -AnalysisConstants::TWO_PI * k / halfSize);
+            fullTwiddles[k] = std::polar(1.0, -AnalysisConstants::TWO_PI * k / size);
+        }
+        twiddleSize = size;
+    }
+
     void SpectralTransformer::ComputeFFT(const std::vector<std::complex<double>>& timeDomain,
         std::vector<std::complex<double>>& frequencyDomain)
     {
         int size = (int)timeDomain.size();
         int halfSize = size / 2;
         frequencyDomain.assign(size, std::complex<double>(0.0, 0.0));
+        PrepareTwiddles(size);
 
         std::complex<double> phaseFactor, evenPart, oddPart;
 
@@ -18,20 +35,20 @@ namespace SpectralAnalysis
             evenPart = { 0.0, 0.0 };
             oddPart = { 0.0, 0.0 };
 
+            // freqIdx * timeIdx   halfSize,   
+            int phaseIdx = 0;
             for (int timeIdx = 0; timeIdx < halfSize; timeIdx++)
             {
-                phaseFactor = {
-                    std::cos(-AnalysisConstants::TWO_PI * freqIdx * timeIdx / halfSize),
-                    std::sin(-AnalysisConstants::TWO_PI * freqIdx * timeIdx / halfSize)
-                };
+                phaseFactor = halfTwiddles[phaseIdx];
                 evenPart += timeDomain[2 * timeIdx] * phaseFactor;
                 oddPart += timeDomain[2 * timeIdx + 1] * phaseFactor;
+
+                phaseIdx += freqIdx;
+                if (phaseIdx >= halfSize)
+                    phaseIdx -= halfSize;
             }
 
-            phaseFactor = {
-                std::cos(-AnalysisConstants::TWO_PI * freqIdx / size),
-                std::sin(-AnalysisConstants::TWO_PI * freqIdx / size)
-            };
+            phaseFactor = fullTwiddles[freqIdx];
             frequencyDomain[freqIdx] = evenPart + phaseFactor * oddPart;
             frequencyDomain[freqIdx + halfSize] = evenPart - phaseFactor * oddPart;
         }
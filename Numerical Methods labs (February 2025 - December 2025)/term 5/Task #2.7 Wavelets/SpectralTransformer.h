@@ -22,6 +22,14 @@ namespace SpectralAnalysis
         void CalculateConvolution(const std::vector<std::complex<double>>& sequenceA,
             const std::vector<std::complex<double>>& sequenceB,
             std::vector<std::complex<double>>& resultSequence);
+
+    private:
+        //     ,     
+        void PrepareTwiddles(int size);
+
+        int twiddleSize = 0;
+        std::vector<std::complex<double>> halfTwiddles;   // exp(-2*pi*i*k/(size/2))
+        std::vector<std::complex<double>> fullTwiddles;   // exp(-2*pi*i*k/size), k < size/2
     };
 }
 